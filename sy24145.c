@@ -20,170 +20,665 @@
 #include <sound/pcm_params.h>
 #include <sound/tlv.h>
 #include <linux/string.h>
+#include <linux/firmware.h>
+#include <linux/debugfs.h>
+#include <linux/ktime.h>
+#include <linux/workqueue.h>
+#include <linux/pm_runtime.h>
 
 #include "sy24145.h"
 
-static uint32_t sample_rate_g;
+#define CREATE_TRACE_POINTS
+#include "sy24145_trace.h"
+
+#define SY24145_COEF_FW_NAME "sy24145-coef.bin"
+#define SY24145_COEF_FW_MAGIC 0x46435953 /* "SYCF" */
+#define SY24145_COEF_FW_VERSION 1
+#define SY24145_COEF_FW_VERSION_PRESETS 2
+#define SY24145_MAX_PRESETS 16
+
+/* Idle time before the outputs enter standby, "standby-delay-ms" in DT */
+#define SY24145_STANDBY_DELAY_MS 5000
+
+/* DSP fade duration at DSP_FADE_TIME_SEL_X1, doubling with every step */
+#define SY24145_DSP_FADE_X1_US 2000
+
+/*
+ * Coefficient firmware blob, all header fields little endian.
+ * Version 1: header, then count records.
+ * Version 2: header, then count presets of { __le16 num_records, records }.
+ * A record is
+ *   { reg, count, count * SY24145_COEF_BYTES of register data (MSB first) }
+ * and covers count consecutive coefficient registers starting at reg.
+ */
+struct sy24145_coef_fw_header {
+	__le32 magic;
+	__le16 version;
+	__le16 count;
+} __packed;
+
+struct sy24145_coef_fw_record {
+	u8 reg;
+	u8 count;
+	u8 data[];
+} __packed;
+
+/* Physical registers, the coefficient words are mapped above them */
+#define SY24145_NUM_REGS SY24145_COEF_VREG_BASE
+
+/* Largest debugfs "reg_script", enough for every register and the RAM */
+#define SY24145_SCRIPT_MAX 4096
+
+/* Longest the first hw_params waits for the deferred tuning load */
+#define SY24145_INIT_TIMEOUT_MS 3000
+
+/* Bus latency histogram buckets, bucket n counts [2^(n-1), 2^n) us */
+#define SY24145_LAT_BUCKETS 16
+
+/* Retries of a coefficient bank the chip flags with a checksum error */
+#define SY24145_COEF_RETRIES 2
+
+/*
+ * Coefficient banks covered by a hardware checksum. The chip checks them
+ * itself and latches error in ERROR_STATUS on a mismatch, so the driver
+ * never needs to know the checksum algorithm. CHANNEL12_LOUDNESS is not
+ * covered by any checksum.
+ */
+struct sy24145_coef_bank {
+	const char *name;
+	unsigned int first;
+	unsigned int last;
+	unsigned int error;
+};
+
+enum {
+	SY24145_BANK_PBQ,
+	SY24145_BANK_MDRC,
+	SY24145_NUM_BANKS,
+};
+
+static const struct sy24145_coef_bank sy24145_coef_banks[] = {
+	[SY24145_BANK_PBQ] = {
+		.name = "pbq",
+		.first = BQ0,
+		.last = SPEQ5,
+		.error = ERROR_STATUS_PCE,
+	},
+	[SY24145_BANK_MDRC] = {
+		.name = "mdrc",
+		.first = DRC_BQN0,
+		.last = DRC_BQN15,
+		.error = ERROR_STATUS_DRC_CE,
+	},
+};
+
+struct sy24145_coef_preset {
+	size_t pos;
+	unsigned int num_records;
+};
+
+struct sy24145_coef_load_stats {
+	int ret;
+	u16 version;
+	u16 presets;
+	unsigned int written;
+	unsigned int checksum_retries[SY24145_NUM_BANKS];
+	/* Checksum mismatches the read back showed to be false */
+	unsigned int checksum_readbacks[SY24145_NUM_BANKS];
+	s64 time_us;
+	s64 bus_bytes;
+	s64 transfers;
+};
+
+/* Status registers read on a fault interrupt */
+enum {
+	SY24145_FAULT_SRC_STATUS, /* ERROR_STATUS */
+	SY24145_FAULT_SRC_STATUS_2, /* ERROR_STATUS_2 */
+	SY24145_FAULT_SRC_DC, /* ERROR_DC_STATUS */
+	SY24145_NUM_FAULT_SRCS,
+};
+
+struct sy24145_fault_desc {
+	u8 src;
+	u8 mask;
+	const char *name;
+};
+
+static const struct sy24145_fault_desc sy24145_faults[] = {
+	{ SY24145_FAULT_SRC_STATUS, ERROR_STATUS_OTF,
+	  "Over temperature or under voltage" },
+	{ SY24145_FAULT_SRC_STATUS, ERROR_STATUS_OCF, "Over current" },
+	{ SY24145_FAULT_SRC_STATUS, ERROR_STATUS_SF, "Short" },
+	{ SY24145_FAULT_SRC_STATUS, ERROR_STATUS_PWM_DE, "PWM DC" },
+	{ SY24145_FAULT_SRC_STATUS, ERROR_STATUS_LRCLKE, "LRCLK error" },
+	{ SY24145_FAULT_SRC_STATUS, ERROR_STATUS_SCLKE, "SCLK error" },
+	{ SY24145_FAULT_SRC_STATUS, ERROR_STATUS_DRC_CE,
+	  "DRC checksum error" },
+	{ SY24145_FAULT_SRC_STATUS, ERROR_STATUS_PCE, "BQ checksum error" },
+	{ SY24145_FAULT_SRC_STATUS_2, ERROR_STATUS_SLEF, "Short load error" },
+	{ SY24145_FAULT_SRC_STATUS_2, ERROR_STATUS_OLEF, "Open load error" },
+	{ SY24145_FAULT_SRC_DC, ERROR_STATUS_PPEC2,
+	  "Channel 2 p-side DC error" },
+	{ SY24145_FAULT_SRC_DC, ERROR_STATUS_PNEC2,
+	  "Channel 2 n-side DC error" },
+	{ SY24145_FAULT_SRC_DC, ERROR_STATUS_PPEC1,
+	  "Channel 1 p-side DC error" },
+	{ SY24145_FAULT_SRC_DC, ERROR_STATUS_PNEC1,
+	  "Channel 1 n-side DC error" },
+};
+
+#define SY24145_FAULT_EVENTS 64
+
+/* Channels a fault event is attributed to, 0 when not channel specific */
+#define SY24145_FAULT_CH1 BIT(0)
+#define SY24145_FAULT_CH2 BIT(1)
+
+/*
+ * Record read from debugfs "fault_events". seq increments for every fault
+ * interrupt, a gap means events were dropped while the FIFO was full.
+ */
+struct sy24145_fault_event {
+	__u64 timestamp_ns; /* CLOCK_BOOTTIME */
+	__u32 seq;
+	__u8 status[SY24145_NUM_FAULT_SRCS];
+	__u8 channel;
+};
+
+struct sy24145_fault_stats {
+	unsigned int irqs;
+	u8 last[SY24145_NUM_FAULT_SRCS];
+	unsigned int count[ARRAY_SIZE(sy24145_faults)];
+};
+
+struct sy24145_pm_stats {
+	unsigned int resumes;
+	s64 resume_last_us;
+	s64 resume_max_us;
+
+	unsigned int standby_enters;
+	unsigned int wakes;
+	s64 wake_last_us;
+	s64 wake_max_us;
+	/* From the start of a wake up to the trigger of the stream */
+	s64 first_sample_last_us;
+	s64 first_sample_max_us;
+};
+
+/* BQ0..BQ17, each settable as one parametric EQ band */
+#define SY24145_EQ_BANDS (BQ17 - BQ0 + 1)
+
+/* Parametric EQ band types, designed after the RBJ audio EQ cookbook */
+enum {
+	SY24145_EQ_BYPASS,
+	SY24145_EQ_PEAK,
+	SY24145_EQ_LOW_SHELF,
+	SY24145_EQ_HIGH_SHELF,
+	SY24145_EQ_LOW_PASS,
+	SY24145_EQ_HIGH_PASS,
+	SY24145_EQ_NOTCH,
+	SY24145_EQ_NUM_TYPES,
+};
+
+#define SY24145_EQ_FREQ_MIN 20
+#define SY24145_EQ_FREQ_MAX 20000
+#define SY24145_EQ_Q_MIN 30 /* 0.30 */
+#define SY24145_EQ_Q_MAX 2000 /* 20.00 */
+#define SY24145_EQ_GAIN_MAX 150 /* 15.0 dB */
+
+/* Value of a "BQn EQ" bytes control */
+struct sy24145_eq_params {
+	__le32 type;
+	__le32 freq; /* Hz */
+	__le32 q; /* 1/100 */
+	__le32 gain; /* 1/10 dB, signed */
+} __packed;
+
+/* Rates of SY24145_RATES, EQ bands are designed for each of them */
+static const unsigned int sy24145_rates[] = { 32000, 44100, 48000, 96000 };
+
+#define SY24145_NUM_RATES ARRAY_SIZE(sy24145_rates)
+
+struct sy24145_eq_band {
+	struct sy24145_eq_params params;
+	u32 coef[SY24145_NUM_RATES][SY24145_COEF_WORDS];
+};
+
+struct sy24145_eq_ctl {
+	struct soc_bytes_ext bytes;
+	unsigned int band;
+};
+
+/* DRC1..DRC4 bands, each written as one set of limiter parameters */
+#define SY24145_DRC_BANDS 4
+#define SY24145_DRC_REGS 5
+
+/*
+ * Value of a "DRCn parameters" bytes TLV control after its snd_ctl_tlv
+ * header, 24 bit register values in little endian words.
+ */
+struct sy24145_drc_params {
+	__le32 lmt_cfg[3]; /* DRCn_LMT_CFG1..3 */
+	__le32 envlp_tc_up;
+	__le32 envlp_tc_dn;
+} __packed;
+
+/* LMT_CFG1..3 are consecutive, band 4 uses the DRC_ENVLP_TC_* pair */
+static const struct {
+	u8 lmt_cfg;
+	u8 envlp_tc;
+} sy24145_drc_bands[SY24145_DRC_BANDS] = {
+	{ DRC1_LMT_CFG1, DRC1_ENVLP_TC_UP },
+	{ DRC2_LMT_CFG1, DRC2_ENVLP_TC_UP },
+	{ DRC3_LMT_CFG1, DRC3_ENVLP_TC_UP },
+	{ DRC4_LMT_CFG1, DRC_ENVLP_TC_UP },
+};
+
+struct sy24145_drc_ctl {
+	struct soc_bytes_ext bytes;
+	unsigned int band;
+};
+
+struct sy24145_preset_stats {
+	int ret;
+	unsigned int switches;
+	s64 last_us;
+	s64 max_us;
+};
+
+enum {
+	SY24145_BUS_READ,
+	SY24145_BUS_WRITE,
+	SY24145_BUS_DIRS,
+};
+
+struct sy24145_bus_stats {
+	u64 count;
+	u64 bytes;
+	u64 errors;
+	u64 hist[SY24145_LAT_BUCKETS];
+};
+
+/* Driver entry points whose bus cost is reported in debugfs "op_stats" */
+enum {
+	SY24145_OP_PROBE,
+	SY24145_OP_HW_PARAMS,
+	SY24145_OP_SET_FMT,
+	SY24145_OP_MUTE,
+	SY24145_OP_CONTROL,
+	SY24145_NUM_OPS,
+};
+
+static const char *const sy24145_op_names[SY24145_NUM_OPS] = {
+	[SY24145_OP_PROBE] = "probe",
+	[SY24145_OP_HW_PARAMS] = "hw_params",
+	[SY24145_OP_SET_FMT] = "set_fmt",
+	[SY24145_OP_MUTE] = "mute_stream",
+	[SY24145_OP_CONTROL] = "control_put",
+};
+
+/*
+ * Most I2C transactions an operation should need. Cached reads are free and
+ * every register write is a single transaction.
+ */
+#define SY24145_NO_BUDGET UINT_MAX
+
+static const unsigned int sy24145_op_budgets[SY24145_NUM_OPS] = {
+	[SY24145_OP_PROBE] = SY24145_NO_BUDGET,
+	[SY24145_OP_HW_PARAMS] = 2, /* CLOCK_CONTROL, I2S_CONTROL */
+	[SY24145_OP_SET_FMT] = 1, /* I2S_CONTROL */
+	[SY24145_OP_MUTE] = 1, /* SOFT_MUTE */
+	[SY24145_OP_CONTROL] = 1,
+};
+
+struct sy24145_op_stats {
+	u64 calls;
+	u64 over_budget;
+	u64 transfers;
+	u64 bytes;
+	u64 last_transfers;
+	u64 last_bytes;
+	u64 max_transfers;
+	u64 max_bytes;
+};
+
+/* Bus counters at the start of an operation */
+struct sy24145_op_mark {
+	s64 transfers;
+	s64 bytes;
+};
+
+struct sy24145_hw_params_stats {
+	int ret;
+	unsigned int calls;
+	unsigned int skipped;
+	s64 last_us;
+	s64 max_us;
+};
 
 struct sy24145 {
 	struct i2c_client *client;
 	struct regmap *regmap;
+	/*
+	 * Volume and mute register values served to sysfs, under lock, see
+	 * sy24145_state_refresh(). mvol_mute is the DSP_MVOL bit, muted the
+	 * state last requested by mute_stream.
+	 */
 	unsigned int mstr_volume;
 	unsigned int l_volume;
 	unsigned int r_volume;
 
 	bool l_mute;
 	bool r_mute;
+	bool mvol_mute;
+	bool muted;
+
+	/* Stream state set by hw_params, under lock */
+	struct mutex lock;
+	unsigned int sample_rate;
+	/* I2S_FMT_* set by set_fmt */
+	unsigned int dai_format;
+	/*
+	 * Rate and width of the last hw_params, 0 after a failed one. The EQ
+	 * is designed for hw_rate; whether the registers need a write is
+	 * decided from the cache, which reg_script keeps up to date too.
+	 */
+	unsigned int hw_rate;
+	unsigned int hw_width;
+	struct sy24145_hw_params_stats hw_params_stats;
+
+	/*
+	 * Parametric EQ bands set through the "BQn EQ" controls, under lock.
+	 * Pending bands are written by eq_work.
+	 */
+	struct sy24145_eq_band eq[SY24145_EQ_BANDS];
+	DECLARE_BITMAP(eq_set, SY24145_EQ_BANDS);
+	DECLARE_BITMAP(eq_pending, SY24145_EQ_BANDS);
+	struct work_struct eq_work;
+	int eq_ret;
+
+	/*
+	 * The regmap lock. sy24145_reg_batch_write() holds it across its own
+	 * transfer and the cache only update after it; the regmap calls it
+	 * makes meanwhile run as regmap_owner and do not lock again.
+	 */
+	struct mutex regmap_lock;
+	struct task_struct *regmap_owner;
+
+	/* Coefficient RAM mirror kept by the regmap bus, see sy24145_reg_write() */
+	u32 coef[SY24145_NUM_COEF_REGS][SY24145_COEF_WORDS];
+	DECLARE_BITMAP(coef_valid, SY24145_NUM_COEF_REGS);
+	/*
+	 * While coef_defer is set, coefficient writes only update the cache
+	 * and the mirror and mark changed registers in coef_dirty, which
+	 * sy24145_coef_flush() then bursts to the chip.
+	 */
+	bool coef_defer;
+	DECLARE_BITMAP(coef_dirty, SY24145_NUM_COEF_REGS);
+	u64 coef_written;
+	struct mutex coef_lock;
+	/* Read a flagged bank back before rewriting it, debugfs "coef_readback" */
+	bool coef_readback;
+
+	const char *coef_fw_name;
+	struct sy24145_coef_load_stats coef_load;
+
+	/* Tuning load deferred out of probe, init_done once it finished */
+	struct work_struct init_work;
+	struct completion init_done;
+	/* hw_params waited for init_done in vain once, it does not wait again */
+	bool init_timed_out;
+
+	/* Loaded coefficient firmware and its presets, under coef_lock */
+	const struct firmware *coef_fw;
+	struct sy24145_coef_preset presets[SY24145_MAX_PRESETS];
+	unsigned int num_presets;
+	unsigned int preset;
+
+	struct work_struct preset_work;
+	unsigned int preset_req;
+	ktime_t preset_req_time;
+	struct sy24145_preset_stats preset_stats;
+
+	struct sy24145_pm_stats pm_stats;
+	u32 standby_delay_ms;
+
+	/* MONITOR pin routed to the fault interrupt, -1 for the FAULT pin */
+	int fault_monitor_pin;
+	struct sy24145_fault_stats fault_stats;
+	/* PLL_STATUS as read at probe and on the last fault interrupt */
+	u32 pll_status;
+
+	/*
+	 * The fault IRQ thread is the only producer and never locks,
+	 * fault_read_lock serialises the readers.
+	 */
+	DECLARE_KFIFO(fault_events, struct sy24145_fault_event,
+		      SY24145_FAULT_EVENTS);
+	struct mutex fault_read_lock;
+	wait_queue_head_t fault_wait;
+	u32 fault_seq;
+	unsigned int fault_dropped;
+	/*
+	 * Set by runtime resume, consumed by the first trigger after it and
+	 * dropped at shutdown. Accessed with READ_ONCE/WRITE_ONCE.
+	 */
+	ktime_t wake_start;
+	bool wake_pending;
+
+	atomic64_t bus_bytes;
+	atomic64_t bus_transfers;
+	/* Per direction latency histogram, reset through debugfs */
+	spinlock_t bus_stats_lock;
+	struct sy24145_bus_stats bus_stats[SY24145_BUS_DIRS];
+	struct sy24145_op_stats op_stats[SY24145_NUM_OPS];
+
+	struct dentry *debugfs;
+};
+
+static void sy24145_op_begin(struct sy24145 *sy24145,
+			     struct sy24145_op_mark *mark)
+{
+	mark->transfers = atomic64_read(&sy24145->bus_transfers);
+	mark->bytes = atomic64_read(&sy24145->bus_bytes);
+}
+
+/*
+ * Charge the bus traffic since sy24145_op_begin() to op. Traffic of the
+ * fault IRQ or the coefficient workers running meanwhile is charged too.
+ */
+static void sy24145_op_end(struct sy24145 *sy24145, unsigned int op,
+			   const struct sy24145_op_mark *mark)
+{
+	struct sy24145_op_stats *stats = &sy24145->op_stats[op];
+	u64 transfers = atomic64_read(&sy24145->bus_transfers) -
+			mark->transfers;
+	u64 bytes = atomic64_read(&sy24145->bus_bytes) - mark->bytes;
+	bool over = transfers > sy24145_op_budgets[op];
+
+	if (over)
+		dev_dbg(&sy24145->client->dev,
+			"%s took %llu transfers, budget %u\n",
+			sy24145_op_names[op], transfers,
+			sy24145_op_budgets[op]);
+
+	spin_lock(&sy24145->bus_stats_lock);
+	stats->calls++;
+	if (over)
+		stats->over_budget++;
+	stats->transfers += transfers;
+	stats->bytes += bytes;
+	stats->last_transfers = transfers;
+	stats->last_bytes = bytes;
+	stats->max_transfers = max(stats->max_transfers, transfers);
+	stats->max_bytes = max(stats->max_bytes, bytes);
+	spin_unlock(&sy24145->bus_stats_lock);
+}
+
+/*
+ * Physical register map, indexed by the 8 bit register address. Registers
+ * without an entry do not exist. The coefficient registers are only reached
+ * through their words at SY24145_COEF_VREG(), so they carry just the width.
+ */
+
+#define SY24145_REG_R BIT(0)
+#define SY24145_REG_W BIT(1)
+#define SY24145_REG_RW (SY24145_REG_R | SY24145_REG_W)
+/* Changed by the chip itself, never served from the cache */
+#define SY24145_REG_IS_VOLATILE BIT(2)
+/* def is the power-on value */
+#define SY24145_REG_HAS_DEFAULT BIT(3)
+
+struct sy24145_reg_desc {
+	u32 def;
+	/* Number of bytes the chip transfers for the register, MSB first */
+	u8 width;
+	u8 flags;
 };
 
-static const struct reg_default sy24145_reg_defaults_8[] = {
-	{ CLOCK_CONTROL, 0x1A },
-	{ DEVICE_ID, 0x25 },
-	{ ERROR_STATUS, 0x00 },
-	{ SYSTEM_CONTROL_1, 0x5F },
-	{ SYSTEM_CONTROL_2, 0x9E },
-	{ SYSTEM_CONTROL_3, 0x7C },
-	{ SOFT_MUTE, 0x30 },
-	{ MASTER_VOLUME, 0x00 },
-	{ CHANNEL1_VOLUME, 0x9F },
-	{ CHANNEL2_VOLUME, 0x9F },
-	{ ERROR_STATUS_2, 0x00 },
-	{ VOL_FTUNE, 0x00 },
-	{ SOFT_RESET, 0x00 },
-	{ MODULATION_LIMIT, 0x77 },
-	{ PWM_A_CHANNEL_DELAY, 0x00 },
-	{ PWM_B_CHANNEL_DELAY, 0x00 },
-	{ PWM_C_CHANNEL_DELAY, 0x00 },
-	{ PWM_D_CHANNEL_DELAY, 0x00 },
-	{ I2S_CONTROL, 0x10 },
-	{ DSP_CONTROL_1, 0x06 },
-	{ MONITOR_PIN_CONFIGURED_1, 0x00 },
-	{ MONITOR_PIN_CONFIGURED_2, 0x00 },
-	{ PWM_DIRECT_CURRENT_THRESHOLD, 0x05 },
-	{ SHORT_CONTROL, 0xBD },
-	{ FAULT_OUTPUT_TIME, 0x02 },
-	{ OPERATION_MODE, 0x05 },
-	{ CHECKSUM_CONTROL, 0x00 },
-	{ INPUT_MUX, 0x00 },
-	{ DSP_CONTROL_2, 0x00 },
-	{ PWM_CONTROL, 0x30 },
-	{ FAULT_SELECT, 0x12 },
-	{ CHANNEL1_EQ_FILTER_CONTROL_1, 0x00 },
-	{ CHANNEL1_EQ_FILTER_CONTROL_2, 0x00 },
-	{ CHANNEL2_EQ_FILTER_CONTROL_1, 0x00 },
-	{ CHANNEL2_EQ_FILTER_CONTROL_2, 0x00 },
-	{ SPEQ_FILTER_CONTROL_1, 0x00 },
-	{ SPEQ_FILTER_CONTROL_2, 0x00 },
-	{ SPEQ_FILTER_CONTROL_3, 0x00 },
-	{ BIST_CONTROL, 0x00 },
-	{ PLL_CONTROL, 0x0000 },
-	{ SPK_SEQUENCE_BYPASS, 0x00 },
-	{ FUNC_TEST, 0x80 },
-	{ TM_BY_REG, 0x00 },
-	{ PROTECTION_SYSTEM_CONTROL, 0x1F },
-	{ I2C_CONTROL, 0x03 },
-	{ OSCILLATOR_TRIM_CONTROL, 0x01 },
-	{ DRC_FTUNE, 0x20 },
-	{ ERROR_DC_STATUS, 0x00 },
-	{ DSP_CONTROL_3, 0xB0 },
-	{ FUNC_DEBUG, 0xC8 },
-
-};
-static const struct reg_default sy24145_reg_defaults_16[] = {
-	{ PRESCALER, 0x7FFF },
-	{ POSTSCALER, 0x7FFF },
-	{ AUTO_MUTE_THRESHOLD, 0x0000 },
-};
-
-static const struct reg_default sy24145_reg_defaults_24[] = {
-	{ DRC1_LMT_CFG1, 0x3CC30C },
-	{ DRC1_LMT_CFG2, 0x060F83 },
-	{ DRC1_LMT_CFG3, 0x000122 },
-	{ DRC2_LMT_CFG1, 0x3CC30C },
-	{ DRC2_LMT_CFG2, 0x060F83 },
-	{ DRC2_LMT_CFG3, 0x000122 },
-	{ DRC3_LMT_CFG1, 0x3CC30C },
-	{ DRC3_LMT_CFG2, 0x060F83 },
-	{ DRC3_LMT_CFG3, 0x000122 },
-	{ DRC4_LMT_CFG1, 0x3CC30C },
-	{ DRC4_LMT_CFG2, 0x060F83 },
-	{ DRC4_LMT_CFG3, 0x000122 },
-	{ DRC_ENVLP_TC_UP, 0x010000 },
-	{ DRC_ENVLP_TC_DN, 0x7B0000 },
-	{ HARD_CLIPPER_THR, 0x7FFFFF },
-	{ DSP_3D_COEF, 0x400000 },
-	{ DSP_3D_MIX, 0x400000 },
-	{ DRC1_ENVLP_TC_UP, 0x010000 },
-	{ DRC1_ENVLP_TC_DN, 0x7B0000 },
-	{ DRC2_ENVLP_TC_UP, 0x010000 },
-	{ DRC2_ENVLP_TC_DN, 0x7B0000 },
-	{ DRC3_ENVLP_TC_UP, 0x010000 },
-	{ DRC3_ENVLP_TC_DN, 0x7B0000 },
-	{ POWER_METER_CONTROL_RB1, 0x000000 },
-	{ POWER_METER_CONTROL_RB2, 0x000000 },
-};
-
-static const struct reg_default sy24145_reg_defaults_32[] = {
-	{ DRC_CONTROL, 0x01000000 },
-	{ PLL_STATUS, 0x0063002D },
-	{ OSCILLATOR_TRIM_REGISTER1, 0x00001000 },
-	{ OSCILLATOR_TRIM_REGISTER2, 0x00101017 },
-	{ ANALOG_REF_TOP_CONTROL, 0x00000200 },
-	{ INTER_PRIVATE, 0x000000F0 },
-	{ OC_DETECT_WINDOW_WIDTH, 0x00000006 },
-	{ FAULT_OVER_CURRENT_THRESHOLD, 0x00002006 },
-	{ PWM_MUX, 0x00000000 },
-	{ PWM_OUTFLIP_1, 0x40003210 },
-	{ PWM_OUTFLIP_2, 0x1000002F },
-	{ PBQ_CHECKSUM, 0x00000000 },
-	{ MDRC_CHECKSUM, 0x40000000 },
-	{ PBQ_CH2_CHECKSUM, 0x00000000 },
+#define SY24145_REG(_width, _access, _def)                       \
+	{                                                        \
+		.def = (_def), .width = (_width),                \
+		.flags = (_access) | SY24145_REG_HAS_DEFAULT,        \
+	}
+#define SY24145_REG_VOLATILE(_width, _access, _def)              \
+	{                                                        \
+		.def = (_def), .width = (_width),                \
+		.flags = (_access) | SY24145_REG_IS_VOLATILE |   \
+			 SY24145_REG_HAS_DEFAULT,                \
+	}
+#define SY24145_REG_NODEF(_width, _access)                       \
+	{                                                        \
+		.width = (_width), .flags = (_access),           \
+	}
+
+static const struct sy24145_reg_desc sy24145_regs[SY24145_NUM_REGS] = {
+	[CLOCK_CONTROL] = SY24145_REG(1, SY24145_REG_RW, 0x1A),
+	[DEVICE_ID] = SY24145_REG(1, SY24145_REG_R, 0x25),
+	[ERROR_STATUS] = SY24145_REG_VOLATILE(1, SY24145_REG_RW, 0x00),
+	[SYSTEM_CONTROL_1] = SY24145_REG(1, SY24145_REG_RW, 0x5F),
+	[SYSTEM_CONTROL_2] = SY24145_REG(1, SY24145_REG_RW, 0x9E),
+	[SYSTEM_CONTROL_3] = SY24145_REG(1, SY24145_REG_RW, 0x7C),
+	[SOFT_MUTE] = SY24145_REG(1, SY24145_REG_RW, 0x30),
+	[MASTER_VOLUME] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[CHANNEL1_VOLUME] = SY24145_REG(1, SY24145_REG_RW, 0x9F),
+	[CHANNEL2_VOLUME] = SY24145_REG(1, SY24145_REG_RW, 0x9F),
+	[ERROR_STATUS_2] = SY24145_REG_VOLATILE(1, SY24145_REG_R, 0x00),
+	[VOL_FTUNE] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[SOFT_RESET] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[MODULATION_LIMIT] = SY24145_REG(1, SY24145_REG_RW, 0x77),
+	[PWM_A_CHANNEL_DELAY] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[PWM_B_CHANNEL_DELAY] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[PWM_C_CHANNEL_DELAY] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[PWM_D_CHANNEL_DELAY] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[I2S_CONTROL] = SY24145_REG(1, SY24145_REG_RW, 0x10),
+	[DSP_CONTROL_1] = SY24145_REG(1, SY24145_REG_RW, 0x06),
+	[MONITOR_PIN_CONFIGURED_1] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[MONITOR_PIN_CONFIGURED_2] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[PWM_DIRECT_CURRENT_THRESHOLD] = SY24145_REG(1, SY24145_REG_RW, 0x05),
+	[SHORT_CONTROL] = SY24145_REG(1, SY24145_REG_RW, 0xBD),
+	[FAULT_OUTPUT_TIME] = SY24145_REG(1, SY24145_REG_RW, 0x02),
+	[OPERATION_MODE] = SY24145_REG(1, SY24145_REG_RW, 0x05),
+	[CHECKSUM_CONTROL] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[INPUT_MUX] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[DSP_CONTROL_2] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[PWM_CONTROL] = SY24145_REG(1, SY24145_REG_RW, 0x30),
+	[FAULT_SELECT] = SY24145_REG(1, SY24145_REG_RW, 0x12),
+	[CHANNEL1_EQ_FILTER_CONTROL_1] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[CHANNEL1_EQ_FILTER_CONTROL_2] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[CHANNEL2_EQ_FILTER_CONTROL_1] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[CHANNEL2_EQ_FILTER_CONTROL_2] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[SPEQ_FILTER_CONTROL_1] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[SPEQ_FILTER_CONTROL_2] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[SPEQ_FILTER_CONTROL_3] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[PRESCALER] = SY24145_REG(2, SY24145_REG_RW, 0x7FFF),
+	[POSTSCALER] = SY24145_REG(2, SY24145_REG_RW, 0x7FFF),
+	[BQ0 ... CHANNEL12_LOUDNESS] = SY24145_REG_NODEF(SY24145_COEF_BYTES, 0),
+	[SPEQ_ATK_REL_TC_1] = SY24145_REG_NODEF(4, SY24145_REG_RW),
+	[SPEQ_ATK_REL_TC_2] = SY24145_REG_NODEF(4, SY24145_REG_RW),
+	[CH12_MIXER_GAIN] = SY24145_REG_NODEF(4, SY24145_REG_RW),
+	[DRC_CONTROL] = SY24145_REG(4, SY24145_REG_RW, 0x01000000),
+	[DRC1_LMT_CFG1] = SY24145_REG(3, SY24145_REG_RW, 0x3CC30C),
+	[DRC1_LMT_CFG2] = SY24145_REG(3, SY24145_REG_RW, 0x060F83),
+	[DRC1_LMT_CFG3] = SY24145_REG(3, SY24145_REG_RW, 0x000122),
+	[DRC2_LMT_CFG1] = SY24145_REG(3, SY24145_REG_RW, 0x3CC30C),
+	[DRC2_LMT_CFG2] = SY24145_REG(3, SY24145_REG_RW, 0x060F83),
+	[DRC2_LMT_CFG3] = SY24145_REG(3, SY24145_REG_RW, 0x000122),
+	[DRC3_LMT_CFG1] = SY24145_REG(3, SY24145_REG_RW, 0x3CC30C),
+	[DRC3_LMT_CFG2] = SY24145_REG(3, SY24145_REG_RW, 0x060F83),
+	[DRC3_LMT_CFG3] = SY24145_REG(3, SY24145_REG_RW, 0x000122),
+	[DRC4_LMT_CFG1] = SY24145_REG(3, SY24145_REG_RW, 0x3CC30C),
+	[DRC4_LMT_CFG2] = SY24145_REG(3, SY24145_REG_RW, 0x060F83),
+	[DRC4_LMT_CFG3] = SY24145_REG(3, SY24145_REG_RW, 0x000122),
+	[DRC_ENVLP_TC_UP] = SY24145_REG(3, SY24145_REG_RW, 0x010000),
+	[DRC_ENVLP_TC_DN] = SY24145_REG(3, SY24145_REG_RW, 0x7B0000),
+	[AUTO_MUTE_THRESHOLD] = SY24145_REG(2, SY24145_REG_RW, 0x0000),
+	[BIST_CONTROL] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[PLL_STATUS] = SY24145_REG_VOLATILE(4, SY24145_REG_RW, 0x0063002D),
+	[PLL_CONTROL] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[SPK_SEQUENCE_BYPASS] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[FUNC_TEST] = SY24145_REG(1, SY24145_REG_RW, 0x80),
+	[TM_BY_REG] = SY24145_REG(1, SY24145_REG_RW, 0x00),
+	[PROTECTION_SYSTEM_CONTROL] = SY24145_REG(1, SY24145_REG_RW, 0x1F),
+	[I2C_CONTROL] = SY24145_REG(1, SY24145_REG_RW, 0x03),
+	[HARD_CLIPPER_THR] = SY24145_REG(3, SY24145_REG_RW, 0x7FFFFF),
+	[OSCILLATOR_TRIM_CONTROL] = SY24145_REG(1, SY24145_REG_RW, 0x01),
+	[OSCILLATOR_TRIM_REGISTER1] = SY24145_REG(4, SY24145_REG_RW, 0x00001000),
+	[OSCILLATOR_TRIM_REGISTER2] = SY24145_REG(4, SY24145_REG_RW, 0x00101017),
+	[ANALOG_REF_TOP_CONTROL] = SY24145_REG(4, SY24145_REG_RW, 0x00000200),
+	[DSP_3D_COEF] = SY24145_REG(3, SY24145_REG_RW, 0x400000),
+	[DSP_3D_MIX] = SY24145_REG(3, SY24145_REG_RW, 0x400000),
+	[INTER_PRIVATE] = SY24145_REG(4, SY24145_REG_RW, 0x000000F0),
+	[DRC_FTUNE] = SY24145_REG(1, SY24145_REG_RW, 0x20),
+	[OC_DETECT_WINDOW_WIDTH] = SY24145_REG(4, SY24145_REG_RW, 0x00000006),
+	[FAULT_OVER_CURRENT_THRESHOLD] =
+		SY24145_REG(4, SY24145_REG_RW, 0x00002006),
+	[ERROR_DC_STATUS] = SY24145_REG_VOLATILE(1, SY24145_REG_R, 0x00),
+	[DSP_CONTROL_3] = SY24145_REG(1, SY24145_REG_RW, 0xB0),
+	[FUNC_DEBUG] = SY24145_REG(1, SY24145_REG_RW, 0xC8),
+	[DRC1_ENVLP_TC_UP] = SY24145_REG(3, SY24145_REG_RW, 0x010000),
+	[DRC1_ENVLP_TC_DN] = SY24145_REG(3, SY24145_REG_RW, 0x7B0000),
+	[DRC2_ENVLP_TC_UP] = SY24145_REG(3, SY24145_REG_RW, 0x010000),
+	[DRC2_ENVLP_TC_DN] = SY24145_REG(3, SY24145_REG_RW, 0x7B0000),
+	[DRC3_ENVLP_TC_UP] = SY24145_REG(3, SY24145_REG_RW, 0x010000),
+	[DRC3_ENVLP_TC_DN] = SY24145_REG(3, SY24145_REG_RW, 0x7B0000),
+	[PWM_MUX] = SY24145_REG(4, SY24145_REG_RW, 0x00000000),
+	[PWM_OUTFLIP_1] = SY24145_REG(4, SY24145_REG_RW, 0x40003210),
+	[PWM_OUTFLIP_2] = SY24145_REG(4, SY24145_REG_RW, 0x1000002F),
+	[PM_COEF] = SY24145_REG_NODEF(3, SY24145_REG_RW),
+	[POWER_METER_CONTROL_RB1] =
+		SY24145_REG_VOLATILE(3, SY24145_REG_RW, 0x000000),
+	[POWER_METER_CONTROL_RB2] =
+		SY24145_REG_VOLATILE(3, SY24145_REG_R, 0x000000),
+	[PBQ_CHECKSUM] = SY24145_REG_VOLATILE(4, SY24145_REG_RW, 0x00000000),
+	[MDRC_CHECKSUM] = SY24145_REG_VOLATILE(4, SY24145_REG_RW, 0x40000000),
+	[PBQ_CH2_CHECKSUM] = SY24145_REG_VOLATILE(4, SY24145_REG_RW, 0x00000000),
 };
 
 static bool sy24145_readable_reg(struct device *dev, unsigned int reg)
 {
-	switch (reg) {
-	case CLOCK_CONTROL ... VOL_FTUNE:
-	case SOFT_RESET ... PWM_DIRECT_CURRENT_THRESHOLD:
-	case SHORT_CONTROL ... FAULT_OUTPUT_TIME:
-	case OPERATION_MODE ... FAULT_SELECT:
-	case CHANNEL1_EQ_FILTER_CONTROL_1 ... POSTSCALER:
-	case BQ0 ... CHANNEL12_LOUDNESS:
-	case SPEQ_ATK_REL_TC_1 ... HARD_CLIPPER_THR:
-	case OSCILLATOR_TRIM_CONTROL ... ANALOG_REF_TOP_CONTROL:
-	case DSP_3D_COEF ... DRC_FTUNE:
-	case OC_DETECT_WINDOW_WIDTH ... FAULT_OVER_CURRENT_THRESHOLD:
-	case ERROR_DC_STATUS:
-	case DSP_CONTROL_3 ... FUNC_DEBUG:
-	case DRC1_ENVLP_TC_UP ... PBQ_CH2_CHECKSUM:
+	if (reg >= SY24145_COEF_VREG_BASE)
 		return true;
-	default:
-		return false;
-	}
+	return sy24145_regs[reg].flags & SY24145_REG_R;
 }
 
 static bool sy24145_writeable_reg(struct device *dev, unsigned int reg)
 {
-	switch (reg) {
-	case CLOCK_CONTROL:
-	case ERROR_STATUS ... CHANNEL2_VOLUME:
-	case VOL_FTUNE:
-	case SOFT_RESET ... PWM_DIRECT_CURRENT_THRESHOLD:
-	case SHORT_CONTROL ... FAULT_OUTPUT_TIME:
-	case OPERATION_MODE ... FAULT_SELECT:
-	case CHANNEL1_EQ_FILTER_CONTROL_1 ... POSTSCALER:
-	case BQ0 ... CHANNEL12_LOUDNESS:
-	case SPEQ_ATK_REL_TC_1 ... HARD_CLIPPER_THR:
-	case OSCILLATOR_TRIM_CONTROL ... ANALOG_REF_TOP_CONTROL:
-	case DSP_3D_COEF ... DRC_FTUNE:
-	case OC_DETECT_WINDOW_WIDTH ... FAULT_OVER_CURRENT_THRESHOLD:
-	case DSP_CONTROL_3 ... FUNC_DEBUG:
-	case DRC1_ENVLP_TC_UP ... POWER_METER_CONTROL_RB1:
-	case PBQ_CHECKSUM ... PBQ_CH2_CHECKSUM:
+	if (reg >= SY24145_COEF_VREG_BASE)
 		return true;
-	default:
+	return sy24145_regs[reg].flags & SY24145_REG_W;
+}
+
+/* The coefficient words are kept in sync by the regmap bus itself */
+static bool sy24145_volatile_reg(struct device *dev, unsigned int reg)
+{
+	if (reg >= SY24145_COEF_VREG_BASE)
 		return false;
-	}
+	return sy24145_regs[reg].flags & SY24145_REG_IS_VOLATILE;
+}
+
+static unsigned int sy24145_reg_width(unsigned int reg)
+{
+	return sy24145_regs[reg].width;
 }
 
 static const DECLARE_TLV_DB_SCALE(sy24145_vol_tlv_master, -12600, 50, 0);
@@ -195,310 +690,918 @@ static const DECLARE_TLV_DB_SCALE(sy24145_vol_tlv_channels, -7900, 50, 0);
 //right channel. With soft mute, the volume gradually increases or decreases when mute is turned off or on respectively.
 // Channel 1 - left, Channel 2 - right
 
-static const struct snd_kcontrol_new sy24145_controls[] = {
+static const char *const sy24145_fade_time_text[] = { "x1", "x2", "x4",
+						       "x8" };
 
-	// // Soft mute register (0x06)
-	SOC_SINGLE("Channel 1 soft mute", SOFT_MUTE, 0, 1,
-		   SY24145_NO_INVERT), // DDMLR
-	SOC_SINGLE("Channel 2 soft mute", SOFT_MUTE, 1, 1,
-		   SY24145_NO_INVERT), // DDMRR
+static SOC_ENUM_SINGLE_DECL(sy24145_fade_time_enum, DSP_CONTROL_1,
+			    DSP_FADE_TIME_SEL_SHFT, sy24145_fade_time_text);
 
-	// Master volume(0x07)
-	SOC_SINGLE_RANGE_TLV("Master volume", MASTER_VOLUME, 0, 0x3, 0xff,
-			     SY24145_NO_INVERT, sy24145_vol_tlv_master),
+static int sy24145_preset_get(struct snd_kcontrol *kcontrol,
+			      struct snd_ctl_elem_value *ucontrol)
+{
+	struct snd_soc_component *component =
+		snd_soc_kcontrol_component(kcontrol);
+	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
 
-	// Channel 1(0x08) and 2(0x09) volume
-	SOC_SINGLE_RANGE_TLV("Left volume", CHANNEL1_VOLUME, 0, 0x1, 0xFF,
-			     SY24145_NO_INVERT, sy24145_vol_tlv_channels),
-	SOC_SINGLE_RANGE_TLV("Right volume", CHANNEL2_VOLUME, 0, 0x1, 0xFF,
-			     SY24145_NO_INVERT, sy24145_vol_tlv_channels),
-};
+	ucontrol->value.integer.value[0] = READ_ONCE(sy24145->preset_req);
+	return 0;
+}
 
-static const struct snd_soc_dapm_widget sy24145_dapm_widgets[] = {
-	SND_SOC_DAPM_OUTPUT("OUTL"),
-	SND_SOC_DAPM_OUTPUT("OUTR"),
-};
+/* The switch itself runs in sy24145_preset_work() */
+static int sy24145_preset_put(struct snd_kcontrol *kcontrol,
+			      struct snd_ctl_elem_value *ucontrol)
+{
+	struct snd_soc_component *component =
+		snd_soc_kcontrol_component(kcontrol);
+	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
+	unsigned int preset = ucontrol->value.integer.value[0];
 
-static const struct snd_soc_dapm_route sy24145_routes[] = {
-	{ "OUTL", NULL, "Playback" },
-	{ "OUTR", NULL, "Playback" },
+	if (preset >= READ_ONCE(sy24145->num_presets))
+		return -EINVAL;
+	if (preset == READ_ONCE(sy24145->preset_req))
+		return 0;
 
-};
+	WRITE_ONCE(sy24145->preset_req, preset);
+	sy24145->preset_req_time = ktime_get();
+	queue_work(system_unbound_wq, &sy24145->preset_work);
+	return 1;
+}
 
-static void sy24145_set_configuration_settings(struct sy24145 *sy24145)
+/*
+ * Update the sysfs copies of the volume and mute registers from the cache
+ * and notify the attributes that changed. Called under lock by everything
+ * that may write those registers.
+ */
+static void sy24145_state_refresh(struct sy24145 *sy24145)
 {
-	int ret = 0;
-	ret = regmap_update_bits(sy24145->regmap, SOFT_MUTE, HARD_SOFT_UNMUTE_MASK, SOFT_UNMUTE_FROM_CLK_ERR);
-	ret = regmap_update_bits(sy24145->regmap, SYSTEM_CONTROL_2,
-				 LOUDNESS_EN_MASK,
-				 LOUDNESS_EN); // Enable loudness
-	ret = regmap_update_bits(
-		sy24145->regmap, DRC_CONTROL, 15,
-		0xF); // DRC Control: enable drc1, drc2, drc3, drc4
-	ret = regmap_update_bits(sy24145->regmap, MASTER_VOLUME,
-				 MASTER_VOLUME_MASK,
-				 sy24145->mstr_volume); // Master volume
-	ret = regmap_update_bits(sy24145->regmap, CHANNEL1_VOLUME,
-				 CHANNEL_VOLUME_MASK,
-				 sy24145->l_volume); // Left channel volume
-	ret = regmap_update_bits(sy24145->regmap, CHANNEL2_VOLUME,
-				 CHANNEL_VOLUME_MASK,
-				 sy24145->r_volume); // Right channel volume
-	ret = regmap_update_bits(sy24145->regmap, SOFT_MUTE,
-				 DSP_DVOL_MUTE_LEFT_MASK,
-				 (sy24145->l_mute == true) ?
-					 DSP_DVOL_MUTE_LEFT :
-					 DSP_DVOL_UNMUTE_LEFT);
-	ret = regmap_update_bits(sy24145->regmap, SOFT_MUTE,
-				 DSP_DVOL_MUTE_RIGHT_MASK,
-				 (sy24145->r_mute == true) ?
-					 DSP_DVOL_MUTE_RIGHT :
-					 DSP_DVOL_UNMUTE_RIGHT);
-	ret = regmap_update_bits(
-		sy24145->regmap, PWM_CONTROL,
-		PWM_CONTROL_STANDBY_MASK | PWM_CONTROL_SHUTDOWN_MASK,
-		PWM_CONTROL_STANDBY_EXIT |
-			PWM_CONTROL_SHUTDOWN_EXIT); // PWM Control: exit all-channel standby, exit all-channel shutdown
+	struct kobject *kobj = &sy24145->client->dev.kobj;
+	const struct {
+		unsigned int reg;
+		unsigned int mask;
+		unsigned int *copy;
+		const char *attr;
+	} volumes[] = {
+		{ MASTER_VOLUME, MASTER_VOLUME_MASK, &sy24145->mstr_volume,
+		  "master_volume" },
+		{ CHANNEL1_VOLUME, CHANNEL_VOLUME_MASK, &sy24145->l_volume,
+		  "left_volume" },
+		{ CHANNEL2_VOLUME, CHANNEL_VOLUME_MASK, &sy24145->r_volume,
+		  "right_volume" },
+	};
+	const struct {
+		unsigned int mask;
+		bool *copy;
+		const char *attr;
+	} mutes[] = {
+		{ DSP_MVOL_MASK, &sy24145->mvol_mute, "mute" },
+		{ DSP_DVOL_MUTE_LEFT_MASK, &sy24145->l_mute, "left_mute" },
+		{ DSP_DVOL_MUTE_RIGHT_MASK, &sy24145->r_mute, "right_mute" },
+	};
+	unsigned int val = 0;
+
+	lockdep_assert_held(&sy24145->lock);
+
+	for (int i = 0; i < ARRAY_SIZE(volumes); ++i) {
+		if (regmap_read(sy24145->regmap, volumes[i].reg, &val) < 0 ||
+		    (val & volumes[i].mask) == *volumes[i].copy)
+			continue;
+		*volumes[i].copy = val & volumes[i].mask;
+		sysfs_notify(kobj, NULL, volumes[i].attr);
+	}
+
+	if (regmap_read(sy24145->regmap, SOFT_MUTE, &val) < 0)
+		return;
+
+	for (int i = 0; i < ARRAY_SIZE(mutes); ++i) {
+		if (!!(val & mutes[i].mask) == *mutes[i].copy)
+			continue;
+		*mutes[i].copy = val & mutes[i].mask;
+		sysfs_notify(kobj, NULL, mutes[i].attr);
+	}
 }
 
-static void __attribute__((unused)) sy24145_print_reg(struct sy24145 *sy24145)
+static int sy24145_put_volsw(struct snd_kcontrol *kcontrol,
+			     struct snd_ctl_elem_value *ucontrol)
 {
+	struct snd_soc_component *component =
+		snd_soc_kcontrol_component(kcontrol);
+	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
+	struct sy24145_op_mark mark;
 	int ret = 0;
-	unsigned int reg_val = 0;
 
-	printk("\tsy24145 registers\n");
+	sy24145_op_begin(sy24145, &mark);
+	ret = snd_soc_put_volsw(kcontrol, ucontrol);
+	sy24145_op_end(sy24145, SY24145_OP_CONTROL, &mark);
+	/* Only the SOFT_MUTE channel bits use this, keep their sysfs copy */
+	if (ret <= 0)
+		return ret;
 
-	ret = regmap_read(sy24145->regmap, CLOCK_CONTROL, &reg_val);
-	if (ret == 0)
-		printk("sy24145 CLOCK_CONTROL(0x00): %d\n", reg_val);
+	mutex_lock(&sy24145->lock);
+	sy24145_state_refresh(sy24145);
+	mutex_unlock(&sy24145->lock);
+	return ret;
+}
 
-	ret = regmap_read(sy24145->regmap, DEVICE_ID, &reg_val);
-	if (ret == 0)
-		printk("sy24145 DEVICE_ID(0x01): 0x%x\n", reg_val);
+static int sy24145_put_enum(struct snd_kcontrol *kcontrol,
+			    struct snd_ctl_elem_value *ucontrol)
+{
+	struct snd_soc_component *component =
+		snd_soc_kcontrol_component(kcontrol);
+	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
+	struct sy24145_op_mark mark;
+	int ret = 0;
 
-	ret = regmap_read(sy24145->regmap, SYSTEM_CONTROL_2, &reg_val);
-	if (ret == 0)
-		printk("sy24145 SYSTEM_CONTROL_2(0x04): %u\n", reg_val);
+	sy24145_op_begin(sy24145, &mark);
+	ret = snd_soc_put_enum_double(kcontrol, ucontrol);
+	sy24145_op_end(sy24145, SY24145_OP_CONTROL, &mark);
+	return ret;
+}
 
-	ret = regmap_read(sy24145->regmap, SOFT_MUTE, &reg_val);
-	if (ret == 0)
-		printk("sy24145 SOFT_MUTE(0x06): %u\n", reg_val);
+/* Lowest register value of a volume control, the control value is offset */
+static unsigned int sy24145_volume_min(unsigned int reg)
+{
+	return reg == MASTER_VOLUME ? 0x3 : 0x1;
+}
 
-	ret = regmap_read(sy24145->regmap, MASTER_VOLUME, &reg_val);
-	if (ret == 0)
-		printk("sy24145 MASTER_VOLUME(0x07): %u\n", reg_val);
+static int sy24145_volume_get(struct snd_kcontrol *kcontrol,
+			      struct snd_ctl_elem_value *ucontrol)
+{
+	struct snd_soc_component *component =
+		snd_soc_kcontrol_component(kcontrol);
+	struct soc_mixer_control *mc =
+		(struct soc_mixer_control *)kcontrol->private_value;
+	unsigned int min = sy24145_volume_min(mc->reg);
+	unsigned int val = snd_soc_component_read(component, mc->reg);
 
-	ret = regmap_read(sy24145->regmap, I2S_CONTROL, &reg_val);
-	printk("sy24145 I2S_CONTROL(0x15): %u\n", reg_val);
+	ucontrol->value.integer.value[0] = clamp(val, min, min + mc->max) - min;
+	return 0;
+}
 
-	ret = regmap_read(sy24145->regmap, MONITOR_PIN_CONFIGURED_1, &reg_val);
-	if (ret == 0)
-		if (ret == 0)
-			printk("sy24145 MONITOR_PIN_CONFIGURED_1(0x17): %u\n",
-			       reg_val);
+static int sy24145_volume_put(struct snd_kcontrol *kcontrol,
+			      struct snd_ctl_elem_value *ucontrol)
+{
+	struct snd_soc_component *component =
+		snd_soc_kcontrol_component(kcontrol);
+	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
+	struct soc_mixer_control *mc =
+		(struct soc_mixer_control *)kcontrol->private_value;
+	long val = ucontrol->value.integer.value[0];
+	struct sy24145_op_mark mark;
+	int ret = 0;
 
-	ret = regmap_read(sy24145->regmap, PWM_CONTROL, &reg_val);
-	if (ret == 0)
-		printk("sy24145 PWM_CONTROL(0x22): %u\n", reg_val);
+	if (val < 0 || val > mc->max)
+		return -EINVAL;
 
-	ret = regmap_read(sy24145->regmap, PRESCALER, &reg_val);
-	if (ret == 0)
-		printk("sy24145 PRESCALER(0x2C): %u\n", reg_val);
+	val += sy24145_volume_min(mc->reg);
 
-	ret = regmap_read(sy24145->regmap, POSTSCALER, &reg_val);
-	if (ret == 0)
-		printk("sy24145 POSTSCALER(0x2D): %u\n", reg_val);
+	sy24145_op_begin(sy24145, &mark);
+	ret = snd_soc_component_update_bits(component, mc->reg, 0xFF, val);
+	sy24145_op_end(sy24145, SY24145_OP_CONTROL, &mark);
+	if (ret <= 0)
+		return ret;
 
-	ret = regmap_read(sy24145->regmap, DRC_CONTROL, &reg_val);
-	if (ret == 0)
-		printk("sy24145 DRC_CONTROL(0x60): %u\n", reg_val);
+	mutex_lock(&sy24145->lock);
+	sy24145_state_refresh(sy24145);
+	mutex_unlock(&sy24145->lock);
+	return ret;
+}
 
-	ret = regmap_read(sy24145->regmap, PLL_STATUS, &reg_val);
-	if (ret == 0)
-		printk("sy24145 PLL_STATUS(0x71): %u\n", reg_val);
+/*
+ * Fixed point biquad design. Intermediate values are Q28, the chip takes
+ * b0, b1, b2, -a1, -a2 normalised to a0 as 3.23 numbers.
+ */
+#define SY24145_EQ_FRAC 28
+#define SY24145_EQ_ONE (1LL << SY24145_EQ_FRAC)
+#define SY24145_EQ_PI 843314857LL
+#define SY24145_EQ_LN2 186065279LL
+#define SY24145_EQ_LOG2_10 891723283LL
+#define SY24145_COEF_FRAC 23
+#define SY24145_COEF_LIMIT (4LL << SY24145_COEF_FRAC)
 
-	ret = regmap_read(sy24145->regmap, PLL_CONTROL, &reg_val);
-	if (ret == 0)
-		printk("sy24145 PLL_CONTROL(0x72): %u\n", reg_val);
-}
-
-static void __attribute__((unused))
-sy24145_print_errors(struct sy24145 *sy24145)
-{
-	uint32_t err = 0;
-	regmap_read(sy24145->regmap, ERROR_STATUS, &err);
-	printk("sy24145 ERROR_STATUS(0x02): %u\n", err);
-	if ((err & ERROR_STATUS_OTF) != 0)
-		printk("sy24145: Over temperature or under voltage is detected\n");
-	if ((err & ERROR_STATUS_OCF) != 0)
-		printk("sy24145: Over current is detected\n");
-	if ((err & ERROR_STATUS_SF) != 0)
-		printk("sy24145: Short is detected\n");
-	if ((err & ERROR_STATUS_PWM_DE) != 0)
-		printk("sy24145: PWM DC detected\n");
-	if ((err & ERROR_STATUS_LRCLKE) != 0)
-		printk("sy24145: LRCLK error\n");
-	if ((err & ERROR_STATUS_SCLKE) != 0)
-		printk("sy24145: SCLK error\n");
-	if ((err & ERROR_STATUS_DRC_CE) != 0)
-		printk("sy24145: DRC checksum error\n");
-	if ((err & ERROR_STATUS_PCE) != 0)
-		printk("sy24145: BQ checksum error\n");
-
-	regmap_read(sy24145->regmap, ERROR_STATUS_2, &err);
-	printk("sy24145 ERROR_STATUS_2(0x0A): %u\n", err);
-	if ((err & ERROR_STATUS_SLEF) != 0)
-		printk("sy24145: Short load error\n");
-	if ((err & ERROR_STATUS_OLEF) != 0)
-		printk("sy24145: Open load error\n");
-
-	regmap_read(sy24145->regmap, ERROR_DC_STATUS, &err);
-	printk("sy24145 ERROR_DC_STATUS(0x89): %u\n", err);
-	if ((err & ERROR_STATUS_PPEC2) != 0)
-		printk("sy24145: Channel 2 has an p-side DC error\n");
-	if ((err & ERROR_STATUS_PNEC2) != 0)
-		printk("sy24145: Channel 2 has an n-side DC error\n");
-	if ((err & ERROR_STATUS_PPEC1) != 0)
-		printk("sy24145: Channel 1 has an p-side DC error\n");
-	if ((err & ERROR_STATUS_PNEC1) != 0)
-		printk("sy24145: Channel 1 has an n-side DC error\n");
+static s64 sy24145_eq_mul(s64 a, s64 b)
+{
+	return (a * b) >> SY24145_EQ_FRAC;
 }
 
-static int sy24145_parse_dt_property(struct i2c_client *i2c,
-				     struct sy24145 *sy24145)
+/* sin(x) for x in [0, pi/2], Taylor series to x^13 */
+static s64 sy24145_eq_sin(s64 x)
 {
-	const struct device_node *np = i2c->dev.parent->of_node;
-	const struct device *dev_parent = i2c->dev.parent;
-	u32 val = 0;
+	s64 x2 = sy24145_eq_mul(x, x);
+	s64 term = x;
+	s64 sum = x;
 
-	if (!np) {
-		dev_err(dev_parent, "%s() i2c->dev.parent->of_node is NULL\n",
-			__func__);
-		return -ENODEV;
+	for (int n = 1; n <= 6; ++n) {
+		term = -div_s64(sy24145_eq_mul(term, x2), 2 * n * (2 * n + 1));
+		sum += term;
 	}
 
-	np = of_get_child_by_name(i2c->dev.parent->of_node, "sy24145");
-	if (!np) {
-		dev_err(dev_parent, "%s() Can not get child: sy24145\n",
-			__func__);
-		return -ENODEV;
-	}
+	return sum;
+}
 
-	if (of_property_read_u32(np, "master-volume", &val) == 0) {
-		if (val > 0xFF)
-			val = 0xFF;
-		sy24145->mstr_volume = val;
-	} else {
-		printk("Can not read property master-volume\n");
-		sy24145->mstr_volume = 0xFF;
-	}
+/* 2^y, exp() of the fractional part as a Taylor series */
+static s64 sy24145_eq_exp2(s64 y)
+{
+	s64 n = y >> SY24145_EQ_FRAC;
+	s64 t = sy24145_eq_mul(y - n * SY24145_EQ_ONE, SY24145_EQ_LN2);
+	s64 term = SY24145_EQ_ONE;
+	s64 sum = SY24145_EQ_ONE;
 
-	if (of_property_read_u32(np, "left-ch-volume", &val) == 0) {
-		if (val > 0xFF)
-			val = 0xFF;
-		sy24145->l_volume = val;
-	} else {
-		printk("Can not read property left-ch-volume\n");
-		sy24145->l_volume = 0x7F;
+	for (int k = 1; k <= 10; ++k) {
+		term = div_s64(sy24145_eq_mul(term, t), k);
+		sum += term;
 	}
 
-	if (of_property_read_u32(np, "right-ch-volume", &val) == 0) {
-		if (val > 0xFF)
-			val = 0xFF;
-		sy24145->r_volume = val;
-	} else {
-		printk("Can not read property right-ch-volume\n");
-		sy24145->r_volume = 0x7F;
-	}
+	return n >= 0 ? sum << n : sum >> -n;
+}
 
-	sy24145->l_mute = of_property_read_bool(np, "left-ch-mute");
-	sy24145->r_mute = of_property_read_bool(np, "right-ch-mute");
+static int sy24145_eq_check(const struct sy24145_eq_params *params)
+{
+	u32 freq = le32_to_cpu(params->freq);
+	u32 q = le32_to_cpu(params->q);
+	s32 gain = le32_to_cpu(params->gain);
+
+	if (le32_to_cpu(params->type) >= SY24145_EQ_NUM_TYPES)
+		return -EINVAL;
+	if (le32_to_cpu(params->type) == SY24145_EQ_BYPASS)
+		return 0;
+	if (freq < SY24145_EQ_FREQ_MIN || freq > SY24145_EQ_FREQ_MAX ||
+	    q < SY24145_EQ_Q_MIN || q > SY24145_EQ_Q_MAX ||
+	    gain < -SY24145_EQ_GAIN_MAX || gain > SY24145_EQ_GAIN_MAX)
+		return -EINVAL;
 
 	return 0;
 }
 
-static int sy24145_hw_params(struct snd_pcm_substream *substream,
-			     struct snd_pcm_hw_params *params,
-			     struct snd_soc_dai *dai)
+/*
+ * Design a checked band for rate. Corner frequencies above 45% of the rate
+ * are pulled down to it. Returns -ERANGE when a coefficient does not fit
+ * 3.23, which extreme shelves close to Nyquist can cause.
+ */
+static int sy24145_eq_design(const struct sy24145_eq_params *params,
+			     unsigned int rate, u32 coef[SY24145_COEF_WORDS])
 {
-	struct snd_soc_component *component = dai->component;
-	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
-	unsigned int sample_rate = 0;
-	unsigned int brt_sel = 0;
-	unsigned int brt_sel_flag = 0;
-	unsigned int reg_val = 0;
-	unsigned int val_len = 0;
+	u32 freq = min(le32_to_cpu(params->freq), rate * 45 / 100);
+	s64 gain = (s32)le32_to_cpu(params->gain);
+	s64 half = 0, s = 0, c = 0, sn = 0, cs = 0, alpha = 0;
+	s64 a = 0, sqrt_a = 0, ap1 = 0, am1 = 0, k = 0;
+	s64 b[3], den[3];
 
-	switch (params_rate(params)) {
-	case 32000:
-		sample_rate = FS_RATE_CNFG_32kHZ;
-		sample_rate_g = 32000;
-		break;
-	case 96000:
-		sample_rate = FS_RATE_CNFG_96kHZ;
-		sample_rate_g = 96000;
-		break;
-	case 44100:
-		sample_rate = FS_RATE_CNFG_441_48kHZ;
-		brt_sel = BRT_SEL_441kHZ;
-		brt_sel_flag = 1;
-		sample_rate_g = 44100;
-		break;
-	case 48000:
-		sample_rate = FS_RATE_CNFG_441_48kHZ;
-		brt_sel = BRT_SEL_48kHZ;
-		brt_sel_flag = 1;
-		sample_rate_g = 48000;
-		break;
-	default:
-		sample_rate_g = 0;
-		return -EINVAL;
+	if (le32_to_cpu(params->type) == SY24145_EQ_BYPASS) {
+		memset(coef, 0, SY24145_COEF_WORDS * sizeof(*coef));
+		coef[0] = BIT(SY24145_COEF_FRAC);
+		return 0;
 	}
 
-	regmap_update_bits(sy24145->regmap, CLOCK_CONTROL,
-			   FS_CNFG_MANUAL_EN_MASK, FS_CNFG_MANUAL_EN_CONFIG_SR);
+	/* w0 = 2 pi f0 / fs, from the half angle to keep low f0 accurate */
+	half = div_u64(SY24145_EQ_PI * freq, rate);
+	s = sy24145_eq_sin(half);
+	c = sy24145_eq_sin(SY24145_EQ_PI / 2 - half);
+	sn = 2 * sy24145_eq_mul(s, c);
+	cs = SY24145_EQ_ONE - 2 * sy24145_eq_mul(s, s);
+	alpha = div_s64(sn * 100, 2 * le32_to_cpu(params->q));
 
-	if (brt_sel_flag == 1)
-		regmap_update_bits(sy24145->regmap, CLOCK_CONTROL, BRT_SEL_MASK,
-				   brt_sel);
-	regmap_update_bits(sy24145->regmap, CLOCK_CONTROL, FS_RATE_CNFG_MASK,
-			   sample_rate);
+	/* A = 10^(gain / 40), gain in 1/10 dB */
+	a = sy24145_eq_exp2(div_s64(gain * SY24145_EQ_LOG2_10, 400));
+	sqrt_a = sy24145_eq_exp2(div_s64(gain * SY24145_EQ_LOG2_10, 800));
+	ap1 = a + SY24145_EQ_ONE;
+	am1 = a - SY24145_EQ_ONE;
+	k = 2 * sy24145_eq_mul(sqrt_a, alpha);
 
-	regmap_read(sy24145->regmap, CLOCK_CONTROL, &reg_val);
+	den[0] = SY24145_EQ_ONE + alpha;
+	den[1] = -2 * cs;
+	den[2] = SY24145_EQ_ONE - alpha;
 
-	switch (params_width(params)) {
-	case 16:
-		val_len = I2S_VBITS_16;
+	switch (le32_to_cpu(params->type)) {
+	case SY24145_EQ_PEAK:
+		b[0] = SY24145_EQ_ONE + sy24145_eq_mul(alpha, a);
+		b[1] = -2 * cs;
+		b[2] = SY24145_EQ_ONE - sy24145_eq_mul(alpha, a);
+		den[0] = SY24145_EQ_ONE +
+			 div64_s64(alpha * SY24145_EQ_ONE, a);
+		den[2] = SY24145_EQ_ONE -
+			 div64_s64(alpha * SY24145_EQ_ONE, a);
 		break;
-	case 18:
-		val_len = I2S_VBITS_18;
+	case SY24145_EQ_LOW_SHELF:
+		b[0] = sy24145_eq_mul(a, ap1 - sy24145_eq_mul(am1, cs) + k);
+		b[1] = 2 * sy24145_eq_mul(a, am1 - sy24145_eq_mul(ap1, cs));
+		b[2] = sy24145_eq_mul(a, ap1 - sy24145_eq_mul(am1, cs) - k);
+		den[0] = ap1 + sy24145_eq_mul(am1, cs) + k;
+		den[1] = -2 * (am1 + sy24145_eq_mul(ap1, cs));
+		den[2] = ap1 + sy24145_eq_mul(am1, cs) - k;
 		break;
-	case 20:
-		val_len = I2S_VBITS_20;
+	case SY24145_EQ_HIGH_SHELF:
+		b[0] = sy24145_eq_mul(a, ap1 + sy24145_eq_mul(am1, cs) + k);
+		b[1] = -2 * sy24145_eq_mul(a, am1 + sy24145_eq_mul(ap1, cs));
+		b[2] = sy24145_eq_mul(a, ap1 + sy24145_eq_mul(am1, cs) - k);
+		den[0] = ap1 - sy24145_eq_mul(am1, cs) + k;
+		den[1] = 2 * (am1 - sy24145_eq_mul(ap1, cs));
+		den[2] = ap1 - sy24145_eq_mul(am1, cs) - k;
 		break;
-	case 24:
-		val_len = I2S_VBITS_24;
+	case SY24145_EQ_LOW_PASS:
+		b[0] = (SY24145_EQ_ONE - cs) / 2;
+		b[1] = SY24145_EQ_ONE - cs;
+		b[2] = b[0];
+		break;
+	case SY24145_EQ_HIGH_PASS:
+		b[0] = (SY24145_EQ_ONE + cs) / 2;
+		b[1] = -(SY24145_EQ_ONE + cs);
+		b[2] = b[0];
+		break;
+	case SY24145_EQ_NOTCH:
+		b[0] = SY24145_EQ_ONE;
+		b[1] = -2 * cs;
+		b[2] = SY24145_EQ_ONE;
 		break;
 	default:
 		return -EINVAL;
 	}
 
-	regmap_update_bits(sy24145->regmap, I2S_CONTROL, I2S_VBITS_MASK,
-			   val_len);
+	for (int i = 0; i < SY24145_COEF_WORDS; ++i) {
+		s64 v = i < 3 ? b[i] : -den[i - 2];
+
+		v = div64_s64(v * SY24145_EQ_ONE, den[0]);
+		v = (v + (1LL << (SY24145_EQ_FRAC - SY24145_COEF_FRAC - 1))) >>
+		    (SY24145_EQ_FRAC - SY24145_COEF_FRAC);
+		if (v < -SY24145_COEF_LIMIT || v >= SY24145_COEF_LIMIT)
+			return -ERANGE;
+
+		coef[i] = v & GENMASK(25, 0);
+	}
+
 	return 0;
 }
 
-static int sy24145_set_dai_fmt(struct snd_soc_dai *codec_dai, unsigned int fmt)
+static int sy24145_rate_index(unsigned int rate)
 {
-	struct snd_soc_component *component = codec_dai->component;
-	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
-	unsigned int sclk = 0;
-	unsigned int lrclk = 0;
-	unsigned int format = 0;
+	for (int i = 0; i < SY24145_NUM_RATES; ++i)
+		if (sy24145_rates[i] == rate)
+			return i;
 
-	switch (fmt & SND_SOC_DAIFMT_INV_MASK) {
-	case SND_SOC_DAIFMT_NB_NF:
-		sclk = I2S_SCLK_NOT_INVERT;
+	return -EINVAL;
+}
+
+/* Queue the bank of every set band for a new rate, called with lock held */
+static void sy24145_eq_set_rate(struct sy24145 *sy24145)
+{
+	lockdep_assert_held(&sy24145->lock);
+
+	bitmap_copy(sy24145->eq_pending, sy24145->eq_set, SY24145_EQ_BANDS);
+}
+
+static int sy24145_eq_get(struct snd_kcontrol *kcontrol,
+			  struct snd_ctl_elem_value *ucontrol)
+{
+	struct snd_soc_component *component =
+		snd_soc_kcontrol_component(kcontrol);
+	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
+	struct sy24145_eq_ctl *ctl =
+		(struct sy24145_eq_ctl *)kcontrol->private_value;
+
+	mutex_lock(&sy24145->lock);
+	memcpy(ucontrol->value.bytes.data, &sy24145->eq[ctl->band].params,
+	       sizeof(struct sy24145_eq_params));
+	mutex_unlock(&sy24145->lock);
+
+	return 0;
+}
+
+static int sy24145_eq_put(struct snd_kcontrol *kcontrol,
+			  struct snd_ctl_elem_value *ucontrol)
+{
+	struct snd_soc_component *component =
+		snd_soc_kcontrol_component(kcontrol);
+	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
+	struct sy24145_eq_ctl *ctl =
+		(struct sy24145_eq_ctl *)kcontrol->private_value;
+	struct sy24145_eq_band *band = &sy24145->eq[ctl->band];
+	struct sy24145_eq_params params;
+	u32 coef[SY24145_NUM_RATES][SY24145_COEF_WORDS];
+	int ret = 0;
+
+	memcpy(&params, ucontrol->value.bytes.data, sizeof(params));
+	ret = sy24145_eq_check(&params);
+	if (ret < 0)
+		return ret;
+
+	/* A band has to be realisable at every rate a stream may switch to */
+	for (int i = 0; i < SY24145_NUM_RATES; ++i) {
+		ret = sy24145_eq_design(&params, sy24145_rates[i], coef[i]);
+		if (ret < 0)
+			return ret;
+	}
+
+	mutex_lock(&sy24145->lock);
+
+	if (test_bit(ctl->band, sy24145->eq_set) &&
+	    memcmp(&band->params, &params, sizeof(params)) == 0)
+		goto out;
+
+	band->params = params;
+	memcpy(band->coef, coef, sizeof(coef));
+	set_bit(ctl->band, sy24145->eq_set);
+	ret = 1;
+
+	/* hw_params writes the bands once the rate is known */
+	if (sy24145->hw_rate) {
+		set_bit(ctl->band, sy24145->eq_pending);
+		queue_work(system_unbound_wq, &sy24145->eq_work);
+	}
+
+out:
+	mutex_unlock(&sy24145->lock);
+	return ret;
+}
+
+/* Register of word i of struct sy24145_drc_params */
+static unsigned int sy24145_drc_reg(unsigned int band, unsigned int i)
+{
+	if (i < 3)
+		return sy24145_drc_bands[band].lmt_cfg + i;
+
+	return sy24145_drc_bands[band].envlp_tc + i - 3;
+}
+
+static int sy24145_reg_batch_write(struct sy24145 *sy24145, const u8 *regs,
+				   const u32 *vals, unsigned int num);
+
+static int sy24145_drc_get(struct snd_kcontrol *kcontrol,
+			   unsigned int __user *bytes, unsigned int size)
+{
+	struct snd_soc_component *component =
+		snd_soc_kcontrol_component(kcontrol);
+	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
+	struct sy24145_drc_ctl *ctl =
+		(struct sy24145_drc_ctl *)kcontrol->private_value;
+	struct snd_ctl_tlv __user *tlv = (struct snd_ctl_tlv __user *)bytes;
+	struct snd_ctl_tlv header = {
+		.numid = kcontrol->id.numid,
+		.length = sizeof(struct sy24145_drc_params),
+	};
+	__le32 words[SY24145_DRC_REGS];
+	unsigned int val = 0;
+	int ret = 0;
+
+	if (size < sizeof(header) + sizeof(words))
+		return -ENOSPC;
+
+	/* Served from the register cache */
+	for (int i = 0; i < SY24145_DRC_REGS; ++i) {
+		ret = regmap_read(sy24145->regmap,
+				  sy24145_drc_reg(ctl->band, i), &val);
+		if (ret < 0)
+			return ret;
+		words[i] = cpu_to_le32(val);
+	}
+
+	if (copy_to_user(tlv, &header, sizeof(header)) ||
+	    copy_to_user(tlv->tlv, words, sizeof(words)))
+		return -EFAULT;
+
+	return 0;
+}
+
+static int sy24145_drc_put(struct snd_kcontrol *kcontrol,
+			   const unsigned int __user *bytes, unsigned int size)
+{
+	struct snd_soc_component *component =
+		snd_soc_kcontrol_component(kcontrol);
+	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
+	struct sy24145_drc_ctl *ctl =
+		(struct sy24145_drc_ctl *)kcontrol->private_value;
+	const struct snd_ctl_tlv __user *tlv =
+		(const struct snd_ctl_tlv __user *)bytes;
+	struct snd_ctl_tlv header;
+	__le32 words[SY24145_DRC_REGS];
+	u8 regs[SY24145_DRC_REGS];
+	u32 vals[SY24145_DRC_REGS];
+	struct sy24145_op_mark mark;
+	unsigned int num = 0;
+	unsigned int old = 0;
+	int ret = 0;
+
+	if (size < sizeof(header) + sizeof(words))
+		return -EINVAL;
+	if (copy_from_user(&header, tlv, sizeof(header)))
+		return -EFAULT;
+	if (header.length != sizeof(words))
+		return -EINVAL;
+	if (copy_from_user(words, tlv->tlv, sizeof(words)))
+		return -EFAULT;
+
+	for (int i = 0; i < SY24145_DRC_REGS; ++i)
+		if (le32_to_cpu(words[i]) > GENMASK(23, 0))
+			return -EINVAL;
+
+	sy24145_op_begin(sy24145, &mark);
+	mutex_lock(&sy24145->lock);
+
+	/* Unchanged registers are skipped, the rest goes out in one transfer */
+	for (int i = 0; i < SY24145_DRC_REGS && ret == 0; ++i) {
+		unsigned int reg = sy24145_drc_reg(ctl->band, i);
+
+		ret = regmap_read(sy24145->regmap, reg, &old);
+		if (ret < 0 || old == le32_to_cpu(words[i]))
+			continue;
+		regs[num] = reg;
+		vals[num++] = le32_to_cpu(words[i]);
+	}
+
+	if (ret == 0)
+		ret = sy24145_reg_batch_write(sy24145, regs, vals, num);
+
+	mutex_unlock(&sy24145->lock);
+	sy24145_op_end(sy24145, SY24145_OP_CONTROL, &mark);
+
+	return ret;
+}
+
+#define SY24145_DRC_BAND(n)                                                  \
+	{                                                                    \
+		.iface = SNDRV_CTL_ELEM_IFACE_MIXER,                         \
+		.name = "DRC" #n " parameters",                              \
+		.access = SNDRV_CTL_ELEM_ACCESS_TLV_READWRITE |              \
+			  SNDRV_CTL_ELEM_ACCESS_TLV_CALLBACK,                \
+		.tlv.c = snd_soc_bytes_tlv_callback,                         \
+		.info = snd_soc_bytes_info_ext,                              \
+		.private_value = (unsigned long)&(struct sy24145_drc_ctl){   \
+			.bytes = {                                           \
+				.max = sizeof(struct snd_ctl_tlv) +          \
+				       sizeof(struct sy24145_drc_params),    \
+				.get = sy24145_drc_get,                      \
+				.put = sy24145_drc_put,                      \
+			},                                                   \
+			.band = (n) - 1,                                     \
+		},                                                           \
+	}
+
+#define SY24145_EQ_BAND(n)                                                   \
+	{                                                                    \
+		.iface = SNDRV_CTL_ELEM_IFACE_MIXER, .name = "BQ" #n " EQ",  \
+		.info = snd_soc_bytes_info_ext, .get = sy24145_eq_get,       \
+		.put = sy24145_eq_put,                                       \
+		.private_value = (unsigned long)&(struct sy24145_eq_ctl){    \
+			.bytes.max = sizeof(struct sy24145_eq_params),       \
+			.band = n,                                           \
+		},                                                           \
+	}
+
+static const struct snd_kcontrol_new sy24145_controls[] = {
+
+	// // Soft mute register (0x06)
+	SOC_SINGLE_EXT("Channel 1 soft mute", SOFT_MUTE, 0, 1,
+		       SY24145_NO_INVERT, snd_soc_get_volsw,
+		       sy24145_put_volsw), // DDMLR
+	SOC_SINGLE_EXT("Channel 2 soft mute", SOFT_MUTE, 1, 1,
+		       SY24145_NO_INVERT, snd_soc_get_volsw,
+		       sy24145_put_volsw), // DDMRR
+
+	// Master volume(0x07), register values 0x3..0xFF
+	SOC_SINGLE_EXT_TLV("Master volume", MASTER_VOLUME, 0, 0xFF - 0x3,
+			   SY24145_NO_INVERT, sy24145_volume_get,
+			   sy24145_volume_put, sy24145_vol_tlv_master),
+
+	// Channel 1(0x08) and 2(0x09) volume, register values 0x1..0xFF
+	SOC_SINGLE_EXT_TLV("Left volume", CHANNEL1_VOLUME, 0, 0xFF - 0x1,
+			   SY24145_NO_INVERT, sy24145_volume_get,
+			   sy24145_volume_put, sy24145_vol_tlv_channels),
+	SOC_SINGLE_EXT_TLV("Right volume", CHANNEL2_VOLUME, 0, 0xFF - 0x1,
+			   SY24145_NO_INVERT, sy24145_volume_get,
+			   sy24145_volume_put, sy24145_vol_tlv_channels),
+
+	// DSP Control register 1 (0x16)
+	SOC_ENUM_EXT("DSP fade time", sy24145_fade_time_enum,
+		     snd_soc_get_enum_double, sy24145_put_enum),
+
+	SOC_SINGLE_EXT("Coefficient preset", SND_SOC_NOPM, 0,
+		       SY24145_MAX_PRESETS - 1, SY24145_NO_INVERT,
+		       sy24145_preset_get, sy24145_preset_put),
+
+	// Parametric EQ bands on BQ0(0x2F)..BQ17(0x40)
+	SY24145_EQ_BAND(0),
+	SY24145_EQ_BAND(1),
+	SY24145_EQ_BAND(2),
+	SY24145_EQ_BAND(3),
+	SY24145_EQ_BAND(4),
+	SY24145_EQ_BAND(5),
+	SY24145_EQ_BAND(6),
+	SY24145_EQ_BAND(7),
+	SY24145_EQ_BAND(8),
+	SY24145_EQ_BAND(9),
+	SY24145_EQ_BAND(10),
+	SY24145_EQ_BAND(11),
+	SY24145_EQ_BAND(12),
+	SY24145_EQ_BAND(13),
+	SY24145_EQ_BAND(14),
+	SY24145_EQ_BAND(15),
+	SY24145_EQ_BAND(16),
+	SY24145_EQ_BAND(17),
+
+	// DRC band limiters, DRC1..4_LMT_CFG1..3 and envelope time constants
+	SY24145_DRC_BAND(1),
+	SY24145_DRC_BAND(2),
+	SY24145_DRC_BAND(3),
+	SY24145_DRC_BAND(4),
+};
+
+static const struct snd_soc_dapm_widget sy24145_dapm_widgets[] = {
+	SND_SOC_DAPM_OUTPUT("OUTL"),
+	SND_SOC_DAPM_OUTPUT("OUTR"),
+};
+
+static const struct snd_soc_dapm_route sy24145_routes[] = {
+	{ "OUTL", NULL, "Playback" },
+	{ "OUTR", NULL, "Playback" },
+
+};
+
+/* Route the fault status to the MONITOR pin wired to the interrupt */
+static int sy24145_set_fault_monitor_pin(struct sy24145 *sy24145)
+{
+	switch (sy24145->fault_monitor_pin) {
+	case 0:
+		return regmap_update_bits(sy24145->regmap,
+					  MONITOR_PIN_CONFIGURED_1,
+					  MONITOR0_CFG_MASK | MONITOR0_EN_MASK,
+					  MONITOR0_CFG_FAULT_PIN_STAT |
+						  MONITOR0_EN);
+	case 1:
+		return regmap_update_bits(sy24145->regmap,
+					  MONITOR_PIN_CONFIGURED_2,
+					  MONITOR1_CFG_MASK,
+					  MONITOR1_CFG_FAULT_PIN_STAT) ?:
+		       regmap_update_bits(sy24145->regmap,
+					  MONITOR_PIN_CONFIGURED_1,
+					  MONITOR1_EN_MASK, MONITOR1_EN);
+	case 2:
+		return regmap_update_bits(sy24145->regmap,
+					  MONITOR_PIN_CONFIGURED_2,
+					  MONITOR2_CFG_MASK,
+					  MONITOR2_CFG_FAULT_PIN_STAT) ?:
+		       regmap_update_bits(sy24145->regmap,
+					  MONITOR_PIN_CONFIGURED_1,
+					  MONITOR2_EN_MASK, MONITOR2_EN);
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Stage the initial configuration in the cache only, then write it out in a
+ * single regcache_sync(), which skips every register still at its
+ * sy24145_regs power-on value.
+ */
+static int sy24145_set_configuration_settings(struct sy24145 *sy24145)
+{
+	const struct {
+		unsigned int reg;
+		unsigned int mask;
+		unsigned int val;
+	} config[] = {
+		{ SOFT_MUTE,
+		  HARD_SOFT_UNMUTE_MASK | DSP_DVOL_MUTE_LEFT_MASK |
+			  DSP_DVOL_MUTE_RIGHT_MASK,
+		  SOFT_UNMUTE_FROM_CLK_ERR |
+			  (sy24145->l_mute ? DSP_DVOL_MUTE_LEFT :
+					     DSP_DVOL_UNMUTE_LEFT) |
+			  (sy24145->r_mute ? DSP_DVOL_MUTE_RIGHT :
+					     DSP_DVOL_UNMUTE_RIGHT) },
+		{ SYSTEM_CONTROL_2, LOUDNESS_EN_MASK,
+		  LOUDNESS_EN }, // Enable loudness
+		{ DRC_CONTROL, 15,
+		  0xF }, // DRC Control: enable drc1, drc2, drc3, drc4
+		{ MASTER_VOLUME, MASTER_VOLUME_MASK, sy24145->mstr_volume },
+		{ CHANNEL1_VOLUME, CHANNEL_VOLUME_MASK, sy24145->l_volume },
+		{ CHANNEL2_VOLUME, CHANNEL_VOLUME_MASK, sy24145->r_volume },
+		// PWM Control: exit all-channel standby, exit all-channel shutdown
+		{ PWM_CONTROL,
+		  PWM_CONTROL_STANDBY_MASK | PWM_CONTROL_SHUTDOWN_MASK,
+		  PWM_CONTROL_STANDBY_EXIT | PWM_CONTROL_SHUTDOWN_EXIT },
+	};
+	int ret = 0;
+
+	regcache_cache_only(sy24145->regmap, true);
+
+	for (int i = 0; i < ARRAY_SIZE(config); ++i) {
+		ret = regmap_update_bits(sy24145->regmap, config[i].reg,
+					 config[i].mask, config[i].val);
+		if (ret < 0)
+			break;
+	}
+
+	if (ret == 0)
+		ret = sy24145_set_fault_monitor_pin(sy24145);
+
+	regcache_cache_only(sy24145->regmap, false);
+	if (ret < 0)
+		return ret;
+
+	return regcache_sync(sy24145->regmap);
+}
+
+static int sy24145_parse_dt_property(struct i2c_client *i2c,
+				     struct sy24145 *sy24145)
+{
+	const struct device_node *np = i2c->dev.parent->of_node;
+	const struct device *dev_parent = i2c->dev.parent;
+	u32 val = 0;
+
+	if (!np) {
+		dev_err(dev_parent, "%s() i2c->dev.parent->of_node is NULL\n",
+			__func__);
+		return -ENODEV;
+	}
+
+	np = of_get_child_by_name(i2c->dev.parent->of_node, "sy24145");
+	if (!np) {
+		dev_err(dev_parent, "%s() Can not get child: sy24145\n",
+			__func__);
+		return -ENODEV;
+	}
+
+	if (of_property_read_u32(np, "master-volume", &val) == 0) {
+		if (val > 0xFF)
+			val = 0xFF;
+		sy24145->mstr_volume = val;
+	} else {
+		printk("Can not read property master-volume\n");
+		sy24145->mstr_volume = 0xFF;
+	}
+
+	if (of_property_read_u32(np, "left-ch-volume", &val) == 0) {
+		if (val > 0xFF)
+			val = 0xFF;
+		sy24145->l_volume = val;
+	} else {
+		printk("Can not read property left-ch-volume\n");
+		sy24145->l_volume = 0x7F;
+	}
+
+	if (of_property_read_u32(np, "right-ch-volume", &val) == 0) {
+		if (val > 0xFF)
+			val = 0xFF;
+		sy24145->r_volume = val;
+	} else {
+		printk("Can not read property right-ch-volume\n");
+		sy24145->r_volume = 0x7F;
+	}
+
+	sy24145->l_mute = of_property_read_bool(np, "left-ch-mute");
+	sy24145->r_mute = of_property_read_bool(np, "right-ch-mute");
+
+	of_property_read_string(np, "coef-firmware", &sy24145->coef_fw_name);
+	of_property_read_u32(np, "standby-delay-ms",
+			     &sy24145->standby_delay_ms);
+
+	if (of_property_read_u32(np, "fault-monitor-pin", &val) == 0 &&
+	    val <= 2)
+		sy24145->fault_monitor_pin = val;
+
+	return 0;
+}
+
+static int sy24145_hw_params(struct snd_pcm_substream *substream,
+			     struct snd_pcm_hw_params *params,
+			     struct snd_soc_dai *dai)
+{
+	struct snd_soc_component *component = dai->component;
+	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
+	struct sy24145_hw_params_stats *stats = &sy24145->hw_params_stats;
+	unsigned int rate = params_rate(params);
+	unsigned int width = params_width(params);
+	unsigned int clk_mask = FS_CNFG_MANUAL_EN_MASK | FS_RATE_CNFG_MASK;
+	unsigned int clk_val = FS_CNFG_MANUAL_EN_CONFIG_SR;
+	unsigned int vbits = 0;
+	ktime_t start = ktime_get();
+	struct sy24145_op_mark mark;
+	unsigned int old_rate = 0;
+	bool rate_changed = false;
+	bool eq_pending = false;
+	bool clk_changed = false;
+	bool fmt_changed = false;
+	s64 delta = 0;
+	int ret = 0;
+
+	sy24145_op_begin(sy24145, &mark);
+
+	/* Start on the final tuning rather than switching it mid-stream */
+	if (!READ_ONCE(sy24145->init_timed_out) &&
+	    !wait_for_completion_timeout(&sy24145->init_done,
+			msecs_to_jiffies(SY24145_INIT_TIMEOUT_MS))) {
+		WRITE_ONCE(sy24145->init_timed_out, true);
+		dev_warn(component->dev, "Tuning not loaded yet, playing flat\n");
+	}
+
+	switch (rate) {
+	case 32000:
+		clk_val |= FS_RATE_CNFG_32kHZ;
+		break;
+	case 96000:
+		clk_val |= FS_RATE_CNFG_96kHZ;
+		break;
+	case 44100:
+		clk_mask |= BRT_SEL_MASK;
+		clk_val |= FS_RATE_CNFG_441_48kHZ | BRT_SEL_441kHZ;
+		break;
+	case 48000:
+		clk_mask |= BRT_SEL_MASK;
+		clk_val |= FS_RATE_CNFG_441_48kHZ | BRT_SEL_48kHZ;
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	switch (width) {
+	case 16:
+		vbits = I2S_VBITS_16;
+		break;
+	case 18:
+		vbits = I2S_VBITS_18;
+		break;
+	case 20:
+		vbits = I2S_VBITS_20;
+		break;
+	case 24:
+	/* The chip takes the 24 MSBs of a 32 bit sample */
+	case 32:
+		vbits = I2S_VBITS_24;
+		break;
+	default:
+		ret = -EINVAL;
+		break;
+	}
+
+	mutex_lock(&sy24145->lock);
+	old_rate = sy24145->sample_rate;
+
+	/* Right justified data would lose its MSBs instead */
+	if (width == 32 && sy24145->dai_format == I2S_FMT_RJ)
+		ret = -EINVAL;
+
+	if (ret < 0) {
+		sy24145->sample_rate = 0;
+		goto out;
+	}
+
+	sy24145->sample_rate = rate;
+
+	/* Both registers are cached, repeated parameters cost no bus traffic */
+	ret = regmap_update_bits_check(sy24145->regmap, CLOCK_CONTROL,
+				       clk_mask, clk_val, &clk_changed);
+	if (ret == 0)
+		ret = regmap_update_bits_check(sy24145->regmap, I2S_CONTROL,
+					       I2S_VBITS_MASK, vbits,
+					       &fmt_changed);
+
+	if (ret == 0) {
+		if (!clk_changed && !fmt_changed)
+			stats->skipped++;
+		if (rate != sy24145->hw_rate)
+			sy24145_eq_set_rate(sy24145);
+		sy24145->hw_rate = rate;
+		sy24145->hw_width = width;
+	} else {
+		sy24145->hw_rate = 0;
+		sy24145->hw_width = 0;
+	}
+
+out:
+	delta = ktime_us_delta(ktime_get(), start);
+	stats->calls++;
+	stats->ret = ret;
+	stats->last_us = delta;
+	stats->max_us = max(stats->max_us, delta);
+	eq_pending = !bitmap_empty(sy24145->eq_pending, SY24145_EQ_BANDS);
+	rate_changed = sy24145->sample_rate != old_rate;
+	mutex_unlock(&sy24145->lock);
+
+	sy24145_op_end(sy24145, SY24145_OP_HW_PARAMS, &mark);
+
+	if (rate_changed)
+		sysfs_notify(&sy24145->client->dev.kobj, NULL, "sample_rate");
+
+	/* The stream starts with the EQ designed for its rate */
+	if (eq_pending) {
+		queue_work(system_unbound_wq, &sy24145->eq_work);
+		flush_work(&sy24145->eq_work);
+	}
+
+	return ret;
+}
+
+static int sy24145_set_dai_fmt(struct snd_soc_dai *codec_dai, unsigned int fmt)
+{
+	struct snd_soc_component *component = codec_dai->component;
+	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
+	struct sy24145_op_mark mark;
+	unsigned int sclk = 0;
+	unsigned int lrclk = 0;
+	unsigned int format = 0;
+	int ret = 0;
+
+	switch (fmt & SND_SOC_DAIFMT_INV_MASK) {
+	case SND_SOC_DAIFMT_NB_NF:
+		sclk = I2S_SCLK_NOT_INVERT;
 		lrclk = I2S_LR_POLARITY_NOT_INVERT;
 		break;
 	case SND_SOC_DAIFMT_NB_IF:
@@ -517,10 +1620,6 @@ static int sy24145_set_dai_fmt(struct snd_soc_dai *codec_dai, unsigned int fmt)
 		return -EINVAL;
 	}
 
-	regmap_update_bits(sy24145->regmap, I2S_CONTROL,
-			   I2S_LR_POLARITY_MASK | I2S_SCLK_INV_MASK,
-			   sclk | lrclk);
-
 	switch (fmt & SND_SOC_DAIFMT_FORMAT_MASK) {
 	case SND_SOC_DAIFMT_I2S:
 		format = I2S_FMT_I2S;
@@ -535,39 +1634,98 @@ static int sy24145_set_dai_fmt(struct snd_soc_dai *codec_dai, unsigned int fmt)
 		return -EINVAL;
 	}
 
-	regmap_update_bits(sy24145->regmap, I2S_CONTROL,
-			   I2S_FMT_MASK | I2S_LR_POLARITY_MASK |
-				   I2S_SCLK_INV_MASK,
-			   format | sclk | lrclk);
-	return 0;
+	sy24145_op_begin(sy24145, &mark);
+	mutex_lock(&sy24145->lock);
+	ret = regmap_update_bits(sy24145->regmap, I2S_CONTROL,
+				 I2S_FMT_MASK | I2S_LR_POLARITY_MASK |
+					 I2S_SCLK_INV_MASK,
+				 format | sclk | lrclk);
+	if (ret == 0)
+		sy24145->dai_format = format;
+	mutex_unlock(&sy24145->lock);
+	sy24145_op_end(sy24145, SY24145_OP_SET_FMT, &mark);
+	return ret;
 }
 
 static int sy24145_mute_stream(struct snd_soc_dai *dai, int mute, int direction)
 {
 	struct snd_soc_component *component = dai->component;
 	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(component);
+	struct sy24145_op_mark mark;
 	unsigned int val = 0;
+	int ret = 0;
 
 	val = (mute > 0) ? DSP_MVOL_MUTE : DSP_MVOL_UNMUTE;
 
-	return regmap_update_bits(sy24145->regmap, SOFT_MUTE, DSP_MVOL_MASK,
-				  val);
+	/* Under lock, a preset switch fades with the same DSP_MVOL bit */
+	sy24145_op_begin(sy24145, &mark);
+	mutex_lock(&sy24145->lock);
+	ret = regmap_update_bits(sy24145->regmap, SOFT_MUTE, DSP_MVOL_MASK,
+				 val);
+	if (ret == 0) {
+		sy24145->muted = mute > 0;
+		sy24145_state_refresh(sy24145);
+	}
+	mutex_unlock(&sy24145->lock);
+	sy24145_op_end(sy24145, SY24145_OP_MUTE, &mark);
+	return ret;
+}
+
+/* The outputs leave standby for the stream, see sy24145_runtime_resume() */
+static int sy24145_startup(struct snd_pcm_substream *substream,
+			   struct snd_soc_dai *dai)
+{
+	return pm_runtime_resume_and_get(dai->component->dev);
+}
+
+static void sy24145_shutdown(struct snd_pcm_substream *substream,
+			     struct snd_soc_dai *dai)
+{
+	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(dai->component);
+
+	/* A wake never followed by a start must not time a later stream */
+	WRITE_ONCE(sy24145->wake_pending, false);
+	pm_runtime_mark_last_busy(dai->component->dev);
+	pm_runtime_put_autosuspend(dai->component->dev);
+}
+
+static int sy24145_trigger(struct snd_pcm_substream *substream, int cmd,
+			   struct snd_soc_dai *dai)
+{
+	struct sy24145 *sy24145 = snd_soc_component_get_drvdata(dai->component);
+	struct sy24145_pm_stats *stats = &sy24145->pm_stats;
+
+	if (cmd != SNDRV_PCM_TRIGGER_START ||
+	    !READ_ONCE(sy24145->wake_pending))
+		return 0;
+
+	WRITE_ONCE(sy24145->wake_pending, false);
+	stats->first_sample_last_us =
+		ktime_us_delta(ktime_get(), READ_ONCE(sy24145->wake_start));
+	stats->first_sample_max_us = max(stats->first_sample_max_us,
+					 stats->first_sample_last_us);
+	return 0;
 }
 
 static const struct snd_soc_dai_ops sy24145_dai_ops = {
+	.startup = sy24145_startup,
+	.shutdown = sy24145_shutdown,
 	.hw_params = sy24145_hw_params,
 	.set_fmt = sy24145_set_dai_fmt,
 	.mute_stream = sy24145_mute_stream,
+	.trigger = sy24145_trigger,
 };
 
 #define SY24145_RATES                                                        \
 	SNDRV_PCM_RATE_32000 | SNDRV_PCM_RATE_44100 | SNDRV_PCM_RATE_48000 | \
 		SNDRV_PCM_RATE_96000
+/* .endianness makes the core add the little endian variants */
 #define SY24145_FORMATS                                        \
 	(SNDRV_PCM_FMTBIT_U16_BE | SNDRV_PCM_FMTBIT_S16_BE |   \
 	 SNDRV_PCM_FMTBIT_U18_3BE | SNDRV_PCM_FMTBIT_S18_3BE | \
 	 SNDRV_PCM_FMTBIT_U20_3BE | SNDRV_PCM_FMTBIT_S20_3BE | \
-	 SNDRV_PCM_FMTBIT_U24_BE | SNDRV_PCM_FMTBIT_S24_BE)
+	 SNDRV_PCM_FMTBIT_U24_BE | SNDRV_PCM_FMTBIT_S24_BE |   \
+	 SNDRV_PCM_FMTBIT_S24_3BE | SNDRV_PCM_FMTBIT_S32_BE)
 
 static struct snd_soc_dai_driver sy24145_dai = {
 	.name = "sy24145-hifi",
@@ -593,293 +1751,2203 @@ static const struct snd_soc_component_driver sy24145_component_driver = {
 	.legacy_dai_naming = 1
 };
 
-static const struct regmap_config sy24145_regmap_config[] = {
+static const struct i2c_device_id sy24145_id[] = {
+	{ "sy24145", 0 },
+	{},
+};
+MODULE_DEVICE_TABLE(i2c, sy24145_id);
+
+#ifdef CONFIG_OF
+static const struct of_device_id sy24145_of_ids[] = {
+	{
+		.compatible = "silergy,sy24145",
+	},
+	{}
+};
+MODULE_DEVICE_TABLE(of, sy24145_of_ids);
+#endif
+
+#ifdef CONFIG_ACPI
+static const struct acpi_device_id sy24145_acpi_match[] = {
+	{ "SYL24145", 0 },
+	{},
+};
+MODULE_DEVICE_TABLE(acpi, sy24145_acpi_match);
+#endif
+
+static void sy24145_bus_account(struct sy24145 *sy24145, bool read,
+				unsigned int bytes, s64 us, int ret)
+{
+	struct sy24145_bus_stats *stats =
+		&sy24145->bus_stats[read ? SY24145_BUS_READ : SY24145_BUS_WRITE];
+	unsigned int bucket = min_t(unsigned int, fls64(us),
+				    SY24145_LAT_BUCKETS - 1);
+
+	spin_lock(&sy24145->bus_stats_lock);
+	stats->count++;
+	stats->hist[bucket]++;
+	if (ret < 0)
+		stats->errors++;
+	else
+		stats->bytes += bytes;
+	spin_unlock(&sy24145->bus_stats_lock);
+}
+
+static int sy24145_i2c_transfer(struct i2c_client *client,
+				struct i2c_msg *msgs, int num)
+{
+	struct sy24145 *sy24145 = i2c_get_clientdata(client);
+	ktime_t start = ktime_get();
+	unsigned int payload = 0;
+	unsigned int len = 0;
+	bool read = false;
+	s64 delta = 0;
+	int ret = 0;
+
+	ret = i2c_transfer(client->adapter, msgs, num);
+	if (ret >= 0 && ret != num)
+		ret = -EIO;
+
+	delta = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	/* Every write message starts with the register number */
+	for (int i = 0; i < num; ++i) {
+		len += msgs[i].len;
+		if (msgs[i].flags & I2C_M_RD) {
+			payload += msgs[i].len;
+			read = true;
+		} else {
+			payload += msgs[i].len - 1;
+		}
+	}
+
+	trace_sy24145_i2c_xfer(&client->dev, msgs[0].buf[0], read, payload,
+			       delta, ret < 0 ? ret : 0);
+	sy24145_bus_account(sy24145, read, len, div_s64(delta, NSEC_PER_USEC),
+			    ret);
+
+	if (ret < 0)
+		return ret;
+
+	/* Payload plus the address byte of every message */
+	atomic64_add(len + num, &sy24145->bus_bytes);
+	atomic64_inc(&sy24145->bus_transfers);
+
+	return 0;
+}
+
+static int sy24145_i2c_read(struct i2c_client *client, uint8_t reg, uint8_t len,
+			    uint8_t *val)
+{
+	__u8 _reg = reg;
+	__u16 _len = len;
+
+	uint8_t read_buf[20] = { 0 };
+	int err = 0;
+	struct i2c_msg msgs[] = {
+		{
+			/* register number */
+			.addr = client->addr,
+			.flags = 0,
+			.len = sizeof(_reg),
+			.buf = &_reg,
+		},
+		{
+			/* read register contents */
+			.addr = client->addr,
+			.flags = I2C_M_RD,
+			.len = _len,
+			.buf = (__u8 *)read_buf,
+		},
+
+	};
+
+	if (_len > sizeof(read_buf))
+		return -EINVAL;
+
+	err = sy24145_i2c_transfer(client, msgs, ARRAY_SIZE(msgs));
+	if (err < 0) {
+		dev_err(&client->dev, "Error during reading reg 0x%X\n", _reg);
+		return err;
+	}
+
+	memcpy(val, read_buf, _len);
+
+	return 0;
+}
+
+static int sy24145_i2c_write(struct i2c_client *client, uint8_t reg,
+			     uint8_t len, uint8_t *val)
+{
+	__u8 _reg = reg;
+	__u16 _len = len;
+
+	uint8_t write_buf[21] = { 0 };
+	int err = 0;
+	struct i2c_msg msgs[] = {
+		{
+			.addr = client->addr,
+			.flags = 0,
+			.len = _len + 1,
+			.buf = write_buf,
+		},
+	};
+
+	if (_len >= sizeof(write_buf))
+		return -EINVAL;
+
+	write_buf[0] = _reg;
+	// Старшими битами вперед
+	memcpy(write_buf + 1, val, _len);
+
+	err = sy24145_i2c_transfer(client, msgs, ARRAY_SIZE(msgs));
+	if (err < 0) {
+		dev_err(&client->dev, "Error during writing to reg 0x%X\n",
+			_reg);
+		return err;
+	}
+
+	return 0;
+}
+
+static unsigned int sy24145_be_to_val(const uint8_t *buf, unsigned int width)
+{
+	unsigned int val = 0;
+
+	for (unsigned int i = 0; i < width; ++i)
+		val = (val << 8) | buf[i];
+	return val;
+}
+
+static void sy24145_val_to_be(unsigned int val, uint8_t *buf,
+			      unsigned int width)
+{
+	for (unsigned int i = width; i > 0; --i) {
+		buf[i - 1] = val & 0xFF;
+		val >>= 8;
+	}
+}
+
+static int sy24145_coef_read_block(struct sy24145 *sy24145, unsigned int idx)
+{
+	uint8_t buf[SY24145_COEF_BYTES];
+	int ret = 0;
+
+	ret = sy24145_i2c_read(sy24145->client, BQ0 + idx, SY24145_COEF_BYTES,
+			       buf);
+	if (ret < 0)
+		return ret;
+
+	for (int i = 0; i < SY24145_COEF_WORDS; ++i)
+		sy24145->coef[idx][i] = sy24145_be_to_val(buf + i * 4, 4);
+	set_bit(idx, sy24145->coef_valid);
+	return 0;
+}
+
+/*
+ * Regmap bus. Every register is transferred with its own width, so the
+ * regmap cache holds the real value of 16/24/32-bit registers. Coefficient
+ * registers are too wide for a regmap value and are exposed as five 32-bit
+ * words at SY24145_COEF_VREG(); the chip only accepts whole coefficient
+ * registers, so the bus keeps a mirror to compose them from.
+ */
+static int sy24145_reg_read(void *context, unsigned int reg, unsigned int *val)
+{
+	struct sy24145 *sy24145 = context;
+	uint8_t buf[4];
+	unsigned int width = 0;
+	int ret = 0;
+
+	if (reg >= SY24145_COEF_VREG_BASE) {
+		unsigned int idx = (reg - SY24145_COEF_VREG_BASE) /
+				   SY24145_COEF_WORDS;
+
+		/* The mirror is ahead of the chip while a block is dirty */
+		if (!test_bit(idx, sy24145->coef_valid)) {
+			ret = sy24145_coef_read_block(sy24145, idx);
+			if (ret < 0)
+				return ret;
+		}
+		*val = sy24145->coef[idx][(reg - SY24145_COEF_VREG_BASE) %
+					  SY24145_COEF_WORDS];
+		return 0;
+	}
+
+	width = sy24145_reg_width(reg);
+	ret = sy24145_i2c_read(sy24145->client, reg, width, buf);
+	if (ret < 0)
+		return ret;
+
+	*val = sy24145_be_to_val(buf, width);
+	return 0;
+}
+
+static int sy24145_reg_write(void *context, unsigned int reg, unsigned int val)
+{
+	struct sy24145 *sy24145 = context;
+	uint8_t buf[SY24145_COEF_BYTES];
+	unsigned int width = 0;
+	int ret = 0;
+
+	if (reg >= SY24145_COEF_VREG_BASE) {
+		unsigned int idx = (reg - SY24145_COEF_VREG_BASE) /
+				   SY24145_COEF_WORDS;
+
+		if (sy24145->coef_defer) {
+			u32 *word = &sy24145->coef[idx][(reg - SY24145_COEF_VREG_BASE) %
+							SY24145_COEF_WORDS];
+
+			if (!test_bit(idx, sy24145->coef_valid) || *word != val) {
+				*word = val;
+				set_bit(idx, sy24145->coef_dirty);
+			}
+			return 0;
+		}
+
+		if (!test_bit(idx, sy24145->coef_valid)) {
+			ret = sy24145_coef_read_block(sy24145, idx);
+			if (ret < 0)
+				return ret;
+		}
+
+		sy24145->coef[idx][(reg - SY24145_COEF_VREG_BASE) %
+				   SY24145_COEF_WORDS] = val;
+		for (int i = 0; i < SY24145_COEF_WORDS; ++i)
+			sy24145_val_to_be(sy24145->coef[idx][i], buf + i * 4, 4);
+
+		ret = sy24145_i2c_write(sy24145->client, BQ0 + idx,
+					SY24145_COEF_BYTES, buf);
+		if (ret < 0)
+			clear_bit(idx, sy24145->coef_valid);
+		return ret;
+	}
+
+	width = sy24145_reg_width(reg);
+	sy24145_val_to_be(val, buf, width);
+	return sy24145_i2c_write(sy24145->client, reg, width, buf);
+}
+
+/*
+ * Send msgs in as few transfers as the adapter takes, never splitting the
+ * group messages that belong together, such as a write and its read.
+ */
+static int sy24145_i2c_transfer_split(struct i2c_client *client,
+				      struct i2c_msg *msgs, int num, int group)
+{
+	const struct i2c_adapter_quirks *quirks = client->adapter->quirks;
+	int max = num;
+	int ret = 0;
+
+	if (quirks && quirks->max_num_msgs)
+		max = max_t(int, rounddown(quirks->max_num_msgs, group), group);
+
+	for (int i = 0; i < num && ret == 0; i += max)
+		ret = sy24145_i2c_transfer(client, msgs + i, min(max, num - i));
+
+	return ret;
+}
+
+static void sy24145_regmap_lock(void *arg)
+{
+	struct sy24145 *sy24145 = arg;
+
+	if (READ_ONCE(sy24145->regmap_owner) != current)
+		mutex_lock(&sy24145->regmap_lock);
+}
+
+static void sy24145_regmap_unlock(void *arg)
+{
+	struct sy24145 *sy24145 = arg;
+
+	if (READ_ONCE(sy24145->regmap_owner) != current)
+		mutex_unlock(&sy24145->regmap_lock);
+}
+
+/*
+ * Write num registers in a single transfer, one message per run of
+ * consecutive registers, then bring the register cache up to date in cache
+ * only mode. The regmap lock is held throughout, so no other regmap access
+ * lands in between. On error the cache of the batch is dropped, the chip
+ * is read back on the next access.
+ */
+static int sy24145_reg_batch_write(struct sy24145 *sy24145, const u8 *regs,
+				   const u32 *vals, unsigned int num)
+{
+	struct i2c_client *client = sy24145->client;
+	const struct i2c_adapter_quirks *quirks = client->adapter->quirks;
+	unsigned int max_len = UINT_MAX;
+	struct i2c_msg *msgs;
+	uint8_t *data;
+	uint8_t *pos;
+	int num_msgs = 0;
+	int ret = 0;
+
+	lockdep_assert_held(&sy24145->lock);
+
+	if (num == 0)
+		return 0;
+
+	if (quirks && quirks->max_write_len)
+		max_len = quirks->max_write_len;
+
+	msgs = kmalloc_array(num, sizeof(*msgs), GFP_KERNEL);
+	data = kmalloc_array(num, 1 + sizeof(*vals), GFP_KERNEL);
+	if (msgs == NULL || data == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	pos = data;
+	for (unsigned int i = 0; i < num; ++i) {
+		unsigned int width = sy24145_reg_width(regs[i]);
+
+		if (i == 0 || regs[i] != regs[i - 1] + 1 ||
+		    msgs[num_msgs - 1].len + width > max_len) {
+			*pos = regs[i];
+			msgs[num_msgs].addr = client->addr;
+			msgs[num_msgs].flags = 0;
+			msgs[num_msgs].len = 1;
+			msgs[num_msgs].buf = pos++;
+			num_msgs++;
+		}
+
+		sy24145_val_to_be(vals[i], pos, width);
+		pos += width;
+		msgs[num_msgs - 1].len += width;
+	}
+
+	mutex_lock(&sy24145->regmap_lock);
+	WRITE_ONCE(sy24145->regmap_owner, current);
+
+	ret = sy24145_i2c_transfer_split(client, msgs, num_msgs, 1);
+
+	if (ret == 0) {
+		regcache_cache_only(sy24145->regmap, true);
+		for (unsigned int i = 0; i < num && ret == 0; ++i)
+			if (!sy24145_volatile_reg(NULL, regs[i]))
+				ret = regmap_write(sy24145->regmap, regs[i],
+						   vals[i]);
+		regcache_cache_only(sy24145->regmap, false);
+	}
+
+	for (unsigned int i = 0; i < num && ret < 0; ++i)
+		if (!sy24145_volatile_reg(NULL, regs[i]))
+			regcache_drop_region(sy24145->regmap, regs[i], regs[i]);
+
+	WRITE_ONCE(sy24145->regmap_owner, NULL);
+	mutex_unlock(&sy24145->regmap_lock);
+
+out:
+	kfree(data);
+	kfree(msgs);
+	return ret;
+}
+
+static const struct regmap_config sy24145_regmap_config = {
+	.reg_bits = 16,
+	.val_bits = 32,
+	.max_register = SY24145_MAX_REGISTER,
+	.reg_read = sy24145_reg_read,
+	.reg_write = sy24145_reg_write,
+	.cache_type = REGCACHE_RBTREE,
+	.readable_reg = sy24145_readable_reg,
+	.writeable_reg = sy24145_writeable_reg,
+	.volatile_reg = sy24145_volatile_reg,
+};
+
+/* Largest number of coefficient registers the adapter takes in one message */
+static unsigned int sy24145_coef_burst_len(struct sy24145 *sy24145)
+{
+	const struct i2c_adapter_quirks *quirks =
+		sy24145->client->adapter->quirks;
+	unsigned int count = SY24145_NUM_COEF_REGS;
+
+	if (quirks && quirks->max_write_len)
+		count = clamp((quirks->max_write_len - 1) / SY24145_COEF_BYTES,
+			      1, SY24145_NUM_COEF_REGS);
+	return count;
+}
+
+/*
+ * Write count consecutive coefficient registers starting at reg. The chip
+ * auto-increments the register address, so a run goes out as one message
+ * (or as few as the adapter allows). data is in bus order, MSB first.
+ */
+static int sy24145_coef_burst_write(struct sy24145 *sy24145, unsigned int reg,
+				    unsigned int count, const uint8_t *data)
+{
+	unsigned int burst = sy24145_coef_burst_len(sy24145);
+	uint8_t *buf;
+	int ret = 0;
+
+	buf = kmalloc(1 + min(count, burst) * SY24145_COEF_BYTES, GFP_KERNEL);
+	if (buf == NULL)
+		return -ENOMEM;
+
+	while (count > 0) {
+		unsigned int n = min(count, burst);
+		struct i2c_msg msg = {
+			.addr = sy24145->client->addr,
+			.flags = 0,
+			.len = 1 + n * SY24145_COEF_BYTES,
+			.buf = buf,
+		};
+
+		buf[0] = reg;
+		memcpy(buf + 1, data, n * SY24145_COEF_BYTES);
+
+		ret = sy24145_i2c_transfer(sy24145->client, &msg, 1);
+		if (ret < 0) {
+			dev_err(&sy24145->client->dev,
+				"Error during burst write to reg 0x%X\n", reg);
+			break;
+		}
+
+		reg += n;
+		data += n * SY24145_COEF_BYTES;
+		count -= n;
+	}
+
+	kfree(buf);
+	return ret;
+}
+
+/*
+ * Stage count coefficient registers starting at reg into the cache and the
+ * mirror. Only registers whose content differs from the mirror are marked
+ * dirty; nothing reaches the chip until sy24145_coef_flush().
+ */
+static int sy24145_coef_stage(struct sy24145 *sy24145, unsigned int reg,
+			      unsigned int count, const uint8_t *data)
+{
+	unsigned int num_words = count * SY24145_COEF_WORDS;
+	u32 *words;
+	int ret = 0;
+
+	lockdep_assert_held(&sy24145->coef_lock);
+
+	words = kmalloc_array(num_words, sizeof(*words), GFP_KERNEL);
+	if (words == NULL)
+		return -ENOMEM;
+
+	for (unsigned int i = 0; i < num_words; ++i)
+		words[i] = sy24145_be_to_val(data + i * 4, 4);
+
+	sy24145->coef_defer = true;
+	ret = regmap_bulk_write(sy24145->regmap, SY24145_COEF_VREG(reg, 0),
+				words, num_words);
+	sy24145->coef_defer = false;
+
+	/* Every word of these registers is known now */
+	if (ret == 0)
+		bitmap_set(sy24145->coef_valid, reg - BQ0, count);
+
+	kfree(words);
+	return ret;
+}
+
+/*
+ * Write every dirty coefficient register to the chip, one burst per run of
+ * consecutive dirty registers. Registers that fail stay dirty.
+ */
+static int __sy24145_coef_flush(struct sy24145 *sy24145)
+{
+	unsigned int start = 0;
+	unsigned int end = 0;
+	uint8_t *buf;
+	int ret = 0;
+
+	lockdep_assert_held(&sy24145->coef_lock);
+
+	if (bitmap_empty(sy24145->coef_dirty, SY24145_NUM_COEF_REGS))
+		return 0;
+
+	ret = regmap_update_bits(sy24145->regmap, SYSTEM_CONTROL_1,
+				 I2C_ACCESS_COEF_RAM_EN_MASK | RAM_CH1_EN_MASK |
+					 RAM_CH2_EN_MASK,
+				 IACRE_I2C_ACCESS | RCE1_I2C_WR_ON |
+					 RCE2_I2C_WR_ON);
+	if (ret < 0)
+		return ret;
+
+	buf = kmalloc(SY24145_NUM_COEF_REGS * SY24145_COEF_BYTES, GFP_KERNEL);
+	if (buf == NULL)
+		return -ENOMEM;
+
+	for_each_set_bit_from(start, sy24145->coef_dirty,
+			      SY24145_NUM_COEF_REGS) {
+		end = find_next_zero_bit(sy24145->coef_dirty,
+					 SY24145_NUM_COEF_REGS, start);
+
+		for (unsigned int i = start; i < end; ++i)
+			for (int j = 0; j < SY24145_COEF_WORDS; ++j)
+				sy24145_val_to_be(sy24145->coef[i][j],
+						  buf + (i - start) *
+							SY24145_COEF_BYTES +
+							j * 4,
+						  4);
+
+		ret = sy24145_coef_burst_write(sy24145, BQ0 + start,
+					       end - start, buf);
+		if (ret < 0)
+			break;
+
+		bitmap_clear(sy24145->coef_dirty, start, end - start);
+		sy24145->coef_written += end - start;
+		start = end;
+	}
+
+	kfree(buf);
+	return ret;
+}
+
+static int sy24145_coef_flush(struct sy24145 *sy24145)
+{
+	int ret = 0;
+
+	mutex_lock(&sy24145->coef_lock);
+	ret = __sy24145_coef_flush(sy24145);
+	mutex_unlock(&sy24145->coef_lock);
+
+	return ret;
+}
+
+/* Burst read a bank back, 1 when it differs from the mirror */
+static int sy24145_coef_readback(struct sy24145 *sy24145,
+				 const struct sy24145_coef_bank *bank)
+{
+	struct i2c_client *client = sy24145->client;
+	const struct i2c_adapter_quirks *quirks = client->adapter->quirks;
+	unsigned int count = bank->last - bank->first + 1;
+	unsigned int burst = count;
+	u8 addr[SY24145_NUM_COEF_REGS];
+	struct i2c_msg *msgs;
+	uint8_t *buf;
+	int num = 0;
+	int ret = 0;
+
+	if (quirks && quirks->max_read_len)
+		burst = clamp(quirks->max_read_len / SY24145_COEF_BYTES, 1U,
+			      count);
+
+	buf = kmalloc(count * SY24145_COEF_BYTES, GFP_KERNEL);
+	msgs = kmalloc_array(2 * DIV_ROUND_UP(count, burst), sizeof(*msgs),
+			     GFP_KERNEL);
+	if (buf == NULL || msgs == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	for (unsigned int i = 0; i < count; i += burst) {
+		addr[i] = bank->first + i;
+		msgs[num].addr = client->addr;
+		msgs[num].flags = 0;
+		msgs[num].len = 1;
+		msgs[num].buf = &addr[i];
+		msgs[num + 1].addr = client->addr;
+		msgs[num + 1].flags = I2C_M_RD;
+		msgs[num + 1].len = min(count - i, burst) * SY24145_COEF_BYTES;
+		msgs[num + 1].buf = buf + i * SY24145_COEF_BYTES;
+		num += 2;
+	}
+
+	ret = sy24145_i2c_transfer_split(client, msgs, num, 2);
+	if (ret < 0)
+		goto out;
+
+	for (unsigned int i = 0; i < count; ++i)
+		for (int j = 0; j < SY24145_COEF_WORDS; ++j)
+			if (sy24145_be_to_val(buf + i * SY24145_COEF_BYTES +
+						      j * 4,
+					      4) !=
+			    sy24145->coef[bank->first - BQ0 + i][j])
+				ret = 1;
+
+out:
+	kfree(msgs);
+	kfree(buf);
+	return ret;
+}
+
+/*
+ * Check the banks in the mask against the checksum error flags the chip
+ * latches in ERROR_STATUS, a single one byte read. A flagged bank is
+ * rewritten from the mirror, up to SY24145_COEF_RETRIES times. With
+ * coef_readback set, a flagged bank is first read back in bursts and only
+ * rewritten when the read back differs too.
+ */
+static int sy24145_coef_verify(struct sy24145 *sy24145, unsigned long banks)
+{
+	uint8_t err = 0;
+	int ret = 0;
+
+	mutex_lock(&sy24145->coef_lock);
+
+	/* A bank can only be rewritten when the mirror holds all of it */
+	for (int i = 0; i < SY24145_NUM_BANKS; ++i) {
+		unsigned int first = sy24145_coef_banks[i].first - BQ0;
+		unsigned int last = sy24145_coef_banks[i].last - BQ0;
+
+		if (find_next_zero_bit(sy24145->coef_valid, last + 1, first) <=
+		    last)
+			banks &= ~BIT(i);
+	}
+
+	for (int retry = 0; banks != 0; ++retry) {
+		unsigned long failed = 0;
+
+		ret = sy24145_i2c_read(sy24145->client, ERROR_STATUS, 1, &err);
+		if (ret < 0)
+			break;
+
+		for (int i = 0; i < SY24145_NUM_BANKS; ++i) {
+			const struct sy24145_coef_bank *bank =
+				&sy24145_coef_banks[i];
+
+			if (!(banks & BIT(i)) || !(err & bank->error))
+				continue;
+
+			failed |= BIT(i);
+			if (!sy24145->coef_readback)
+				continue;
+
+			ret = sy24145_coef_readback(sy24145, bank);
+			if (ret < 0)
+				break;
+			if (ret == 0) {
+				dev_warn_once(&sy24145->client->dev,
+					      "%s checksum error flagged, but the read back matches\n",
+					      bank->name);
+				sy24145->coef_load.checksum_readbacks[i]++;
+				failed &= ~BIT(i);
+			}
+			ret = 0;
+		}
+		if (ret < 0)
+			break;
+
+		banks = failed;
+		if (banks == 0)
+			break;
+
+		if (retry == SY24145_COEF_RETRIES) {
+			ret = -EIO;
+			break;
+		}
+
+		for (int i = 0; i < SY24145_NUM_BANKS; ++i) {
+			if (!(banks & BIT(i)))
+				continue;
+
+			dev_warn(&sy24145->client->dev,
+				 "%s checksum error (error status 0x%02x), rewriting\n",
+				 sy24145_coef_banks[i].name, err);
+			sy24145->coef_load.checksum_retries[i]++;
+			bitmap_set(sy24145->coef_dirty,
+				   sy24145_coef_banks[i].first - BQ0,
+				   sy24145_coef_banks[i].last -
+					   sy24145_coef_banks[i].first + 1);
+		}
+
+		/* The flags are latched, clear them before the rewrite */
+		ret = regmap_write(sy24145->regmap, ERROR_STATUS, 0);
+		if (ret == 0)
+			ret = __sy24145_coef_flush(sy24145);
+		if (ret < 0)
+			break;
+	}
+
+	mutex_unlock(&sy24145->coef_lock);
+	return ret;
+}
+
+/*
+ * Walk num_records records from *pos, staging them when apply is set, and
+ * collect the checksum banks they touch.
+ */
+static int sy24145_coef_fw_records(struct sy24145 *sy24145,
+				   const struct firmware *fw, size_t *pos,
+				   unsigned int num_records, bool apply,
+				   unsigned long *banks)
+{
+	int ret = 0;
+
+	for (unsigned int i = 0; i < num_records; ++i) {
+		const struct sy24145_coef_fw_record *rec;
+		size_t len = 0;
+
+		if (fw->size - *pos < sizeof(*rec))
+			return -EINVAL;
+		rec = (const void *)(fw->data + *pos);
+		len = rec->count * SY24145_COEF_BYTES;
+
+		if (rec->count == 0 || rec->reg < BQ0 ||
+		    rec->reg + rec->count - 1 > CHANNEL12_LOUDNESS ||
+		    fw->size - *pos - sizeof(*rec) < len)
+			return -EINVAL;
+
+		if (apply) {
+			ret = sy24145_coef_stage(sy24145, rec->reg, rec->count,
+						 rec->data);
+			if (ret < 0)
+				return ret;
+		}
+
+		for (int j = 0; j < SY24145_NUM_BANKS; ++j)
+			if (rec->reg <= sy24145_coef_banks[j].last &&
+			    rec->reg + rec->count - 1 >=
+				    sy24145_coef_banks[j].first)
+				*banks |= BIT(j);
+
+		*pos += sizeof(*rec) + len;
+	}
+
+	return 0;
+}
+
+/* Validate the whole blob and locate its presets */
+static int sy24145_coef_fw_index(struct sy24145 *sy24145,
+				 const struct firmware *fw,
+				 struct sy24145_coef_preset *presets,
+				 unsigned int *num_presets)
+{
+	const struct sy24145_coef_fw_header *hdr = (const void *)fw->data;
+	unsigned int version = 0;
+	unsigned int count = 0;
+	unsigned long banks = 0;
+	size_t pos = sizeof(*hdr);
+	int ret = 0;
+
+	if (fw->size < sizeof(*hdr) ||
+	    le32_to_cpu(hdr->magic) != SY24145_COEF_FW_MAGIC)
+		return -EINVAL;
+
+	version = le16_to_cpu(hdr->version);
+	count = le16_to_cpu(hdr->count);
+
+	switch (version) {
+	case SY24145_COEF_FW_VERSION:
+		presets[0].pos = pos;
+		presets[0].num_records = count;
+		*num_presets = 1;
+		return sy24145_coef_fw_records(sy24145, fw, &pos, count, false,
+					       &banks);
+	case SY24145_COEF_FW_VERSION_PRESETS:
+		if (count == 0 || count > SY24145_MAX_PRESETS)
+			return -EINVAL;
+
+		for (unsigned int i = 0; i < count; ++i) {
+			if (fw->size - pos < sizeof(__le16))
+				return -EINVAL;
+			presets[i].num_records = fw->data[pos] |
+						 fw->data[pos + 1] << 8;
+			pos += sizeof(__le16);
+			presets[i].pos = pos;
+
+			ret = sy24145_coef_fw_records(sy24145, fw, &pos,
+						      presets[i].num_records,
+						      false, &banks);
+			if (ret < 0)
+				return ret;
+		}
+		*num_presets = count;
+		return 0;
+	default:
+		dev_err(&sy24145->client->dev,
+			"Unsupported coefficient firmware version %u\n",
+			version);
+		return -EINVAL;
+	}
+}
+
+/* Mirror state put back when a preset fails to stage partway */
+struct sy24145_coef_shadow {
+	u32 coef[SY24145_NUM_COEF_REGS][SY24145_COEF_WORDS];
+	DECLARE_BITMAP(valid, SY24145_NUM_COEF_REGS);
+	DECLARE_BITMAP(dirty, SY24145_NUM_COEF_REGS);
+};
+
+/*
+ * Put the mirror back to shadow. The cache of every register that changed
+ * is dropped, so it is refilled from the restored mirror.
+ */
+static void sy24145_coef_restore(struct sy24145 *sy24145,
+				 const struct sy24145_coef_shadow *shadow)
+{
+	for (unsigned int idx = 0; idx < SY24145_NUM_COEF_REGS; ++idx)
+		if (test_bit(idx, sy24145->coef_dirty) !=
+			    test_bit(idx, shadow->dirty) ||
+		    memcmp(sy24145->coef[idx], shadow->coef[idx],
+			   sizeof(shadow->coef[idx])))
+			regcache_drop_region(
+				sy24145->regmap, SY24145_COEF_VREG(BQ0 + idx, 0),
+				SY24145_COEF_VREG(BQ0 + idx,
+						  SY24145_COEF_WORDS - 1));
+
+	memcpy(sy24145->coef, shadow->coef, sizeof(shadow->coef));
+	bitmap_copy(sy24145->coef_valid, shadow->valid, SY24145_NUM_COEF_REGS);
+	bitmap_copy(sy24145->coef_dirty, shadow->dirty, SY24145_NUM_COEF_REGS);
+}
+
+/*
+ * Stage every record of a preset. If one fails, the ones before it are
+ * taken back, so a later flush never writes half a preset.
+ */
+static int sy24145_coef_stage_preset(struct sy24145 *sy24145,
+				     unsigned int preset, unsigned long *banks)
+{
+	struct sy24145_coef_shadow *shadow;
+	size_t pos = sy24145->presets[preset].pos;
+	int ret = 0;
+
+	lockdep_assert_held(&sy24145->coef_lock);
+
+	shadow = kmalloc(sizeof(*shadow), GFP_KERNEL);
+	if (shadow == NULL)
+		return -ENOMEM;
+
+	memcpy(shadow->coef, sy24145->coef, sizeof(shadow->coef));
+	bitmap_copy(shadow->valid, sy24145->coef_valid, SY24145_NUM_COEF_REGS);
+	bitmap_copy(shadow->dirty, sy24145->coef_dirty, SY24145_NUM_COEF_REGS);
+
+	ret = sy24145_coef_fw_records(sy24145, sy24145->coef_fw, &pos,
+				      sy24145->presets[preset].num_records,
+				      true, banks);
+	if (ret < 0)
+		sy24145_coef_restore(sy24145, shadow);
+
+	kfree(shadow);
+	return ret;
+}
+
+static int sy24145_load_coef_firmware(struct sy24145 *sy24145)
+{
+	struct device *dev = &sy24145->client->dev;
+	struct sy24145_coef_load_stats *stats = &sy24145->coef_load;
+	struct sy24145_coef_preset presets[SY24145_MAX_PRESETS];
+	const struct firmware *fw;
+	s64 bytes = atomic64_read(&sy24145->bus_bytes);
+	s64 transfers = atomic64_read(&sy24145->bus_transfers);
+	ktime_t start = ktime_get();
+	unsigned int num_presets = 0;
+	unsigned long banks = 0;
+	u64 written = 0;
+	int ret = 0;
+
+	memset(stats->checksum_retries, 0, sizeof(stats->checksum_retries));
+	memset(stats->checksum_readbacks, 0, sizeof(stats->checksum_readbacks));
+	stats->written = 0;
+
+	ret = firmware_request_nowarn(&fw, sy24145->coef_fw_name, dev);
+	if (ret < 0)
+		goto out;
+
+	/* Validate the whole blob before anything reaches the chip */
+	ret = sy24145_coef_fw_index(sy24145, fw, presets, &num_presets);
+	if (ret < 0) {
+		release_firmware(fw);
+		goto out;
+	}
+
+	stats->version = le16_to_cpu(((const struct sy24145_coef_fw_header *)
+					      fw->data)->version);
+	stats->presets = num_presets;
+
+	/* The blob stays loaded so presets can be switched without file I/O */
+	mutex_lock(&sy24145->coef_lock);
+	release_firmware(sy24145->coef_fw);
+	sy24145->coef_fw = fw;
+	memcpy(sy24145->presets, presets, sizeof(presets));
+	WRITE_ONCE(sy24145->num_presets, num_presets);
+	sy24145->preset = 0;
+	WRITE_ONCE(sy24145->preset_req, 0);
+
+	/* Only registers that differ from what the chip holds are written */
+	written = sy24145->coef_written;
+	ret = sy24145_coef_stage_preset(sy24145, 0, &banks);
+	if (ret == 0)
+		ret = __sy24145_coef_flush(sy24145);
+	stats->written = sy24145->coef_written - written;
+	mutex_unlock(&sy24145->coef_lock);
+
+	if (ret == 0)
+		ret = sy24145_coef_verify(sy24145, banks);
+
+out:
+	stats->ret = ret;
+	stats->time_us = ktime_us_delta(ktime_get(), start);
+	stats->bus_bytes = atomic64_read(&sy24145->bus_bytes) - bytes;
+	stats->transfers = atomic64_read(&sy24145->bus_transfers) - transfers;
+
+	/* A missing blob is not an error, the amp plays flat */
+	if (ret == -ENOENT)
+		dev_dbg(dev, "No coefficient firmware %s\n",
+			sy24145->coef_fw_name);
+	else if (ret < 0)
+		dev_err(dev, "Failed to load coefficient firmware %s: %d\n",
+			sy24145->coef_fw_name, ret);
+
+	return ret;
+}
+
+/*
+ * Switch to the requested preset as one operation: stage it in the shadow,
+ * fade the output out through soft mute with the DSP fade engine enabled,
+ * flush only the changed coefficients and fade back in.
+ */
+static void sy24145_preset_work(struct work_struct *work)
+{
+	struct sy24145 *sy24145 =
+		container_of(work, struct sy24145, preset_work);
+	struct sy24145_preset_stats *stats = &sy24145->preset_stats;
+	unsigned int preset = READ_ONCE(sy24145->preset_req);
+	unsigned int soft_mute = 0;
+	unsigned int dsp_ctrl = 0;
+	unsigned int sys_ctrl = 0;
+	unsigned int fade_us = 0;
+	unsigned long banks = 0;
+	bool fade = false;
+	int ret = 0;
+
+	/* lock keeps mute_stream off DSP_MVOL while the switch fades */
+	mutex_lock(&sy24145->lock);
+	mutex_lock(&sy24145->coef_lock);
+
+	if (sy24145->coef_fw == NULL || preset >= sy24145->num_presets) {
+		ret = -ENOENT;
+		goto unlock;
+	}
+
+	ret = sy24145_coef_stage_preset(sy24145, preset, &banks);
+	if (ret < 0 ||
+	    bitmap_empty(sy24145->coef_dirty, SY24145_NUM_COEF_REGS))
+		goto unlock;
+
+	ret = regmap_read(sy24145->regmap, SOFT_MUTE, &soft_mute);
+	if (ret == 0)
+		ret = regmap_read(sy24145->regmap, DSP_CONTROL_1, &dsp_ctrl);
+	if (ret == 0)
+		ret = regmap_read(sy24145->regmap, SYSTEM_CONTROL_1, &sys_ctrl);
+	if (ret < 0)
+		goto unlock;
+
+	/* Nothing to fade if the stream is muted anyway */
+	fade = !sy24145->muted &&
+	       (soft_mute & DSP_MVOL_MASK) == DSP_MVOL_UNMUTE;
+	if (fade) {
+		fade_us = SY24145_DSP_FADE_X1_US
+			  << ((dsp_ctrl & DSP_FADE_TIME_SEL_MASK) >>
+			      DSP_FADE_TIME_SEL_SHFT);
+
+		ret = regmap_update_bits(sy24145->regmap, SYSTEM_CONTROL_1,
+					 DSP_FADE_EN_MASK, DFER_FADE_EN);
+		if (ret == 0)
+			ret = regmap_update_bits(sy24145->regmap, SOFT_MUTE,
+						 DSP_MVOL_MASK, DSP_MVOL_MUTE);
+		if (ret < 0)
+			goto restore;
+		sy24145_state_refresh(sy24145);
+
+		fsleep(fade_us);
+	}
+
+	ret = __sy24145_coef_flush(sy24145);
+
+	if (fade && !sy24145->muted) {
+		regmap_update_bits(sy24145->regmap, SOFT_MUTE, DSP_MVOL_MASK,
+				   DSP_MVOL_UNMUTE);
+		/* Let the fade in finish before the engine goes back off */
+		fsleep(fade_us);
+	}
+
+restore:
+	if (fade)
+		regmap_update_bits(sy24145->regmap, SYSTEM_CONTROL_1,
+				   DSP_FADE_EN_MASK,
+				   sys_ctrl & DSP_FADE_EN_MASK);
+
+unlock:
+	if (ret == 0)
+		sy24145->preset = preset;
+	if (fade)
+		sy24145_state_refresh(sy24145);
+	mutex_unlock(&sy24145->coef_lock);
+	mutex_unlock(&sy24145->lock);
+
+	if (ret == 0)
+		ret = sy24145_coef_verify(sy24145, banks);
+
+	stats->ret = ret;
+	stats->switches++;
+	stats->last_us = ktime_us_delta(ktime_get(), sy24145->preset_req_time);
+	stats->max_us = max(stats->max_us, stats->last_us);
+
+	if (ret < 0)
+		dev_err(&sy24145->client->dev,
+			"Failed to switch to coefficient preset %u: %d\n",
+			preset, ret);
+}
+
+/*
+ * Read ERROR_STATUS..ERROR_STATUS_2, ERROR_DC_STATUS and PLL_STATUS in a
+ * single combined I2C transaction, or one read each where the adapter takes
+ * fewer messages per transfer.
+ */
+static int sy24145_read_faults(struct sy24145 *sy24145,
+			       u8 status[SY24145_NUM_FAULT_SRCS],
+			       u32 *pll_status)
+{
+	struct i2c_client *client = sy24145->client;
+	u8 status_reg = ERROR_STATUS;
+	u8 dc_reg = ERROR_DC_STATUS;
+	u8 pll_reg = PLL_STATUS;
+	u8 buf[ERROR_STATUS_2 - ERROR_STATUS + 1];
+	u8 pll_buf[4];
+	struct i2c_msg msgs[] = {
+		{
+			.addr = client->addr,
+			.flags = 0,
+			.len = sizeof(status_reg),
+			.buf = &status_reg,
+		},
+		{
+			.addr = client->addr,
+			.flags = I2C_M_RD,
+			.len = sizeof(buf),
+			.buf = buf,
+		},
+		{
+			.addr = client->addr,
+			.flags = 0,
+			.len = sizeof(dc_reg),
+			.buf = &dc_reg,
+		},
+		{
+			.addr = client->addr,
+			.flags = I2C_M_RD,
+			.len = 1,
+			.buf = &status[SY24145_FAULT_SRC_DC],
+		},
+		{
+			.addr = client->addr,
+			.flags = 0,
+			.len = sizeof(pll_reg),
+			.buf = &pll_reg,
+		},
+		{
+			.addr = client->addr,
+			.flags = I2C_M_RD,
+			.len = sizeof(pll_buf),
+			.buf = pll_buf,
+		},
+	};
+	const struct i2c_adapter_quirks *quirks = client->adapter->quirks;
+	int ret = 0;
+
+	if (quirks && quirks->max_num_msgs &&
+	    quirks->max_num_msgs < ARRAY_SIZE(msgs)) {
+		ret = sy24145_i2c_read(client, status_reg, sizeof(buf), buf);
+		if (ret == 0)
+			ret = sy24145_i2c_read(client, dc_reg, 1,
+					       &status[SY24145_FAULT_SRC_DC]);
+		if (ret == 0)
+			ret = sy24145_i2c_read(client, pll_reg,
+					       sizeof(pll_buf), pll_buf);
+	} else {
+		ret = sy24145_i2c_transfer(client, msgs, ARRAY_SIZE(msgs));
+	}
+	if (ret < 0)
+		return ret;
+
+	status[SY24145_FAULT_SRC_STATUS] = buf[0];
+	status[SY24145_FAULT_SRC_STATUS_2] = buf[ERROR_STATUS_2 - ERROR_STATUS];
+	*pll_status = sy24145_be_to_val(pll_buf, sizeof(pll_buf));
+	return 0;
+}
+
+static irqreturn_t sy24145_fault_irq(int irq, void *data)
+{
+	struct sy24145 *sy24145 = data;
+	struct sy24145_fault_stats *stats = &sy24145->fault_stats;
+	struct sy24145_fault_event event;
+	u8 status[SY24145_NUM_FAULT_SRCS];
+	u32 pll_status = 0;
+	int ret = 0;
+
+	/* The line is ours, IRQ_NONE would get it disabled */
+	ret = sy24145_read_faults(sy24145, status, &pll_status);
+	if (ret < 0) {
+		dev_err_ratelimited(&sy24145->client->dev,
+				    "Failed to read fault status, %d\n", ret);
+		return IRQ_HANDLED;
+	}
+
+	if (!status[SY24145_FAULT_SRC_STATUS] &&
+	    !status[SY24145_FAULT_SRC_STATUS_2] &&
+	    !status[SY24145_FAULT_SRC_DC])
+		return IRQ_NONE;
+
+	event.timestamp_ns = ktime_get_boottime_ns();
+	event.seq = sy24145->fault_seq++;
+	memcpy(event.status, status, sizeof(event.status));
+	event.channel = 0;
+	if (status[SY24145_FAULT_SRC_DC] &
+	    (ERROR_STATUS_PPEC1 | ERROR_STATUS_PNEC1))
+		event.channel |= SY24145_FAULT_CH1;
+	if (status[SY24145_FAULT_SRC_DC] &
+	    (ERROR_STATUS_PPEC2 | ERROR_STATUS_PNEC2))
+		event.channel |= SY24145_FAULT_CH2;
+
+	if (kfifo_put(&sy24145->fault_events, event))
+		wake_up_interruptible(&sy24145->fault_wait);
+	else
+		sy24145->fault_dropped++;
+
+	stats->irqs++;
+	memcpy(stats->last, status, sizeof(stats->last));
+	for (int i = 0; i < ARRAY_SIZE(sy24145_faults); ++i)
+		if (status[sy24145_faults[i].src] & sy24145_faults[i].mask)
+			stats->count[i]++;
+	sy24145->pll_status = pll_status;
+
+	/* ERROR_STATUS is latched, clear it for the next fault */
+	if (status[SY24145_FAULT_SRC_STATUS])
+		regmap_write(sy24145->regmap, ERROR_STATUS, 0);
+
+	sysfs_notify(&sy24145->client->dev.kobj, NULL, "fault_count");
+	sysfs_notify(&sy24145->client->dev.kobj, NULL, "fault_status");
+	sysfs_notify(&sy24145->client->dev.kobj, NULL, "pll_status");
+
+	return IRQ_HANDLED;
+}
+
+/* Write the banks of the pending EQ bands for hw_rate in one flush */
+static void sy24145_eq_work(struct work_struct *work)
+{
+	struct sy24145 *sy24145 = container_of(work, struct sy24145, eq_work);
+	uint8_t buf[SY24145_COEF_BYTES];
+	unsigned int i;
+	int rate = 0;
+	int ret = 0;
+
+	mutex_lock(&sy24145->lock);
+
+	rate = sy24145_rate_index(sy24145->hw_rate);
+	if (rate < 0) {
+		mutex_unlock(&sy24145->lock);
+		return;
+	}
+
+	mutex_lock(&sy24145->coef_lock);
+
+	/* Only words that differ from the chip reach the bus */
+	for_each_set_bit(i, sy24145->eq_pending, SY24145_EQ_BANDS) {
+		for (int w = 0; w < SY24145_COEF_WORDS; ++w)
+			sy24145_val_to_be(sy24145->eq[i].coef[rate][w],
+					  buf + w * 4, 4);
+		ret = sy24145_coef_stage(sy24145, BQ0 + i, 1, buf);
+		if (ret < 0)
+			break;
+	}
+
+	if (ret == 0)
+		ret = __sy24145_coef_flush(sy24145);
+	if (ret == 0)
+		bitmap_zero(sy24145->eq_pending, SY24145_EQ_BANDS);
+
+	mutex_unlock(&sy24145->coef_lock);
+
+	if (ret == 0)
+		ret = sy24145_coef_verify(sy24145, BIT(SY24145_BANK_PBQ));
+	if (ret < 0)
+		sy24145->eq_ret = ret;
+
+	mutex_unlock(&sy24145->lock);
+}
+
+static void sy24145_init_work(struct work_struct *work)
+{
+	struct sy24145 *sy24145 = container_of(work, struct sy24145,
+					       init_work);
+
+	/* Tuning is optional, the amp plays flat without it */
+	sy24145_load_coef_firmware(sy24145);
+	complete_all(&sy24145->init_done);
+}
+
+static void sy24145_coef_release(void *data)
+{
+	struct sy24145 *sy24145 = data;
+
+	cancel_work_sync(&sy24145->init_work);
+	cancel_work_sync(&sy24145->preset_work);
+	cancel_work_sync(&sy24145->eq_work);
+	release_firmware(sy24145->coef_fw);
+}
+
+static int reverseArr(uint8_t *arr, const int size)
+{
+	for (int i = 0; i < size / 2; ++i) {
+		uint8_t temp = arr[i];
+		arr[i] = arr[size - 1 - i];
+		arr[size - 1 - i] = temp;
+	}
+	return 0;
+}
+
+/*
+ * The attributes below are served from the driver's copy of the state and
+ * never touch the bus. Writers call sysfs_notify() on change, so readers can
+ * poll() for POLLPRI instead of rereading.
+ */
+ssize_t sy24145_sys_show_sample_rate(struct device *dev,
+				     struct device_attribute *attr, char *buf)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+	int ret = 0;
+
+	mutex_lock(&sy24145->lock);
+	ret = sprintf(buf, "%u\n", sy24145->sample_rate);
+	mutex_unlock(&sy24145->lock);
+	return ret;
+}
+
+static DEVICE_ATTR(sample_rate, S_IRUSR, sy24145_sys_show_sample_rate, NULL);
+
+/*
+ * Volumes are shown in 0.5 dB steps relative to 0 dB, which is 0xFF for the
+ * master and 0x9F for the channels, see the TLVs.
+ */
+static ssize_t sy24145_sys_show_volume(struct sy24145 *sy24145,
+				       unsigned int *volume,
+				       unsigned int zero_db, char *buf)
+{
+	unsigned int val = 0;
+
+	mutex_lock(&sy24145->lock);
+	val = *volume;
+	mutex_unlock(&sy24145->lock);
+
+	/* Master volume 0x00 - 0x02 is mute */
+	if (volume == &sy24145->mstr_volume && val <= 2)
+		return sprintf(buf, "0\n");
+	return sprintf(buf, "%d\n", (int)val - (int)zero_db);
+}
+
+ssize_t sy24145_sys_show_master_volume(struct device *dev,
+				       struct device_attribute *attr, char *buf)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+
+	return sy24145_sys_show_volume(sy24145, &sy24145->mstr_volume, 0xFF,
+				       buf);
+}
+
+static DEVICE_ATTR(master_volume, S_IRUSR, sy24145_sys_show_master_volume,
+		   NULL);
+
+static ssize_t sy24145_sys_show_left_volume(struct device *dev,
+					    struct device_attribute *attr,
+					    char *buf)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+
+	return sy24145_sys_show_volume(sy24145, &sy24145->l_volume, 0x9F, buf);
+}
+
+static DEVICE_ATTR(left_volume, S_IRUSR, sy24145_sys_show_left_volume, NULL);
+
+static ssize_t sy24145_sys_show_right_volume(struct device *dev,
+					     struct device_attribute *attr,
+					     char *buf)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+
+	return sy24145_sys_show_volume(sy24145, &sy24145->r_volume, 0x9F, buf);
+}
+
+static DEVICE_ATTR(right_volume, S_IRUSR, sy24145_sys_show_right_volume, NULL);
+
+static ssize_t sy24145_sys_show_mute_state(struct sy24145 *sy24145,
+					   bool *mute, char *buf)
+{
+	bool val = false;
+
+	mutex_lock(&sy24145->lock);
+	val = *mute;
+	mutex_unlock(&sy24145->lock);
+	return sprintf(buf, "%d\n", val);
+}
+
+static ssize_t sy24145_sys_show_mute(struct device *dev,
+				     struct device_attribute *attr, char *buf)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+
+	return sy24145_sys_show_mute_state(sy24145, &sy24145->mvol_mute, buf);
+}
+
+static DEVICE_ATTR(mute, S_IRUSR, sy24145_sys_show_mute, NULL);
+
+static ssize_t sy24145_sys_show_left_mute(struct device *dev,
+					  struct device_attribute *attr,
+					  char *buf)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+
+	return sy24145_sys_show_mute_state(sy24145, &sy24145->l_mute, buf);
+}
+
+static DEVICE_ATTR(left_mute, S_IRUSR, sy24145_sys_show_left_mute, NULL);
+
+static ssize_t sy24145_sys_show_right_mute(struct device *dev,
+					   struct device_attribute *attr,
+					   char *buf)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+
+	return sy24145_sys_show_mute_state(sy24145, &sy24145->r_mute, buf);
+}
+
+static DEVICE_ATTR(right_mute, S_IRUSR, sy24145_sys_show_right_mute, NULL);
+
+static ssize_t sy24145_sys_show_fault_count(struct device *dev,
+					    struct device_attribute *attr,
+					    char *buf)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+
+	return sprintf(buf, "%u\n", READ_ONCE(sy24145->fault_stats.irqs));
+}
+
+static DEVICE_ATTR(fault_count, S_IRUSR, sy24145_sys_show_fault_count, NULL);
+
+/* Faults seen by the last interrupt one per line, "none" before any */
+static ssize_t sy24145_sys_show_fault_status(struct device *dev,
+					     struct device_attribute *attr,
+					     char *buf)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+	u8 last[SY24145_NUM_FAULT_SRCS];
+	ssize_t len = 0;
+
+	memcpy(last, sy24145->fault_stats.last, sizeof(last));
+	for (int i = 0; i < ARRAY_SIZE(sy24145_faults); ++i)
+		if (last[sy24145_faults[i].src] & sy24145_faults[i].mask)
+			len += sysfs_emit_at(buf, len, "%s\n",
+					     sy24145_faults[i].name);
+	if (!len)
+		len = sysfs_emit(buf, "none\n");
+	return len;
+}
+
+static DEVICE_ATTR(fault_status, S_IRUSR, sy24145_sys_show_fault_status, NULL);
+
+static ssize_t sy24145_sys_show_pll_status(struct device *dev,
+					   struct device_attribute *attr,
+					   char *buf)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+
+	return sprintf(buf, "0x%08x\n", READ_ONCE(sy24145->pll_status));
+}
+
+static DEVICE_ATTR(pll_status, S_IRUSR, sy24145_sys_show_pll_status, NULL);
+
+static struct attribute *sy24145_attributes_sample_rate[] = {
+	&dev_attr_sample_rate.attr,
+	NULL,
+};
+
+static struct attribute *sy24145_attributes_master_volume[] = {
+	&dev_attr_master_volume.attr,
+	NULL,
+};
+
+static struct attribute *sy24145_attributes_state[] = {
+	&dev_attr_left_volume.attr,
+	&dev_attr_right_volume.attr,
+	&dev_attr_mute.attr,
+	&dev_attr_left_mute.attr,
+	&dev_attr_right_mute.attr,
+	&dev_attr_fault_count.attr,
+	&dev_attr_fault_status.attr,
+	&dev_attr_pll_status.attr,
+	NULL,
+};
+
+static const struct attribute_group sy24145_sample_rate_group = {
+	.attrs = sy24145_attributes_sample_rate,
+};
+
+static const struct attribute_group sy24145_master_volume_group = {
+	.attrs = sy24145_attributes_master_volume,
+};
+
+static const struct attribute_group sy24145_state_group = {
+	.attrs = sy24145_attributes_state,
+};
+
+static const struct attribute_group *sy24145_groups[] = {
+	&sy24145_sample_rate_group,
+	&sy24145_master_volume_group,
+	&sy24145_state_group,
+	NULL,
+};
+
+static int sy24145_coef_load_show(struct seq_file *s, void *data)
+{
+	struct sy24145 *sy24145 = s->private;
+	struct sy24145_coef_load_stats *stats = &sy24145->coef_load;
+
+	seq_printf(s, "firmware: %s\n", sy24145->coef_fw_name);
+	seq_printf(s, "result: %d\n", stats->ret);
+	seq_printf(s, "version: %u\n", stats->version);
+	seq_printf(s, "presets: %u\n", stats->presets);
+	seq_printf(s, "registers_written: %u\n", stats->written);
+	seq_printf(s, "time_ms: %lld.%03lld\n", stats->time_us / 1000,
+		   stats->time_us % 1000);
+	seq_printf(s, "bus_bytes: %lld\n", stats->bus_bytes);
+	seq_printf(s, "transfers: %lld\n", stats->transfers);
+	for (int i = 0; i < SY24145_NUM_BANKS; ++i)
+		seq_printf(s, "%s_checksum_retries: %u\n",
+			   sy24145_coef_banks[i].name,
+			   stats->checksum_retries[i]);
+	for (int i = 0; i < SY24145_NUM_BANKS; ++i)
+		seq_printf(s, "%s_checksum_readbacks: %u\n",
+			   sy24145_coef_banks[i].name,
+			   stats->checksum_readbacks[i]);
+
+	return 0;
+}
+
+DEFINE_SHOW_ATTRIBUTE(sy24145_coef_load);
+
+static int sy24145_preset_switch_show(struct seq_file *s, void *data)
+{
+	struct sy24145 *sy24145 = s->private;
+	struct sy24145_preset_stats *stats = &sy24145->preset_stats;
+
+	seq_printf(s, "preset: %u\n", sy24145->preset);
+	seq_printf(s, "result: %d\n", stats->ret);
+	seq_printf(s, "switches: %u\n", stats->switches);
+	seq_printf(s, "last_us: %lld\n", stats->last_us);
+	seq_printf(s, "max_us: %lld\n", stats->max_us);
+
+	return 0;
+}
+
+DEFINE_SHOW_ATTRIBUTE(sy24145_preset_switch);
+
+static int sy24145_pm_show(struct seq_file *s, void *data)
+{
+	struct sy24145 *sy24145 = s->private;
+	struct sy24145_pm_stats *stats = &sy24145->pm_stats;
+
+	seq_printf(s, "resumes: %u\n", stats->resumes);
+	seq_printf(s, "resume_last_us: %lld\n", stats->resume_last_us);
+	seq_printf(s, "resume_max_us: %lld\n", stats->resume_max_us);
+	seq_printf(s, "standby_enters: %u\n", stats->standby_enters);
+	seq_printf(s, "wakes: %u\n", stats->wakes);
+	seq_printf(s, "wake_last_us: %lld\n", stats->wake_last_us);
+	seq_printf(s, "wake_max_us: %lld\n", stats->wake_max_us);
+	seq_printf(s, "first_sample_last_us: %lld\n",
+		   stats->first_sample_last_us);
+	seq_printf(s, "first_sample_max_us: %lld\n",
+		   stats->first_sample_max_us);
+
+	return 0;
+}
+
+DEFINE_SHOW_ATTRIBUTE(sy24145_pm);
+
+static int sy24145_hw_params_show(struct seq_file *s, void *data)
+{
+	struct sy24145 *sy24145 = s->private;
+	struct sy24145_hw_params_stats *stats = &sy24145->hw_params_stats;
+
+	mutex_lock(&sy24145->lock);
+	seq_printf(s, "ret: %d\n", stats->ret);
+	seq_printf(s, "calls: %u\n", stats->calls);
+	seq_printf(s, "skipped: %u\n", stats->skipped);
+	seq_printf(s, "rate: %u\n", sy24145->hw_rate);
+	seq_printf(s, "width: %u\n", sy24145->hw_width);
+	seq_printf(s, "last_us: %lld\n", stats->last_us);
+	seq_printf(s, "max_us: %lld\n", stats->max_us);
+	mutex_unlock(&sy24145->lock);
+
+	return 0;
+}
+
+DEFINE_SHOW_ATTRIBUTE(sy24145_hw_params);
+
+static int sy24145_eq_show(struct seq_file *s, void *data)
+{
+	struct sy24145 *sy24145 = s->private;
+	unsigned int i;
+
+	mutex_lock(&sy24145->lock);
+	seq_printf(s, "ret: %d\n", sy24145->eq_ret);
+	seq_printf(s, "rate: %u\n", sy24145->hw_rate);
+	for_each_set_bit(i, sy24145->eq_set, SY24145_EQ_BANDS) {
+		struct sy24145_eq_band *band = &sy24145->eq[i];
+
+		seq_printf(s, "BQ%u: type %u freq %u q %u gain %d%s", i,
+			   le32_to_cpu(band->params.type),
+			   le32_to_cpu(band->params.freq),
+			   le32_to_cpu(band->params.q),
+			   (s32)le32_to_cpu(band->params.gain),
+			   test_bit(i, sy24145->eq_pending) ? " pending" : "");
+		seq_puts(s, "\n");
+		for (int r = 0; r < SY24145_NUM_RATES; ++r) {
+			seq_printf(s, "  %u:", sy24145_rates[r]);
+			for (int w = 0; w < SY24145_COEF_WORDS; ++w)
+				seq_printf(s, " %08x", band->coef[r][w]);
+			seq_puts(s, "\n");
+		}
+	}
+	mutex_unlock(&sy24145->lock);
+
+	return 0;
+}
+
+DEFINE_SHOW_ATTRIBUTE(sy24145_eq);
+
+static int sy24145_faults_show(struct seq_file *s, void *data)
+{
+	struct sy24145 *sy24145 = s->private;
+	struct sy24145_fault_stats *stats = &sy24145->fault_stats;
+
+	seq_printf(s, "irqs: %u\n", stats->irqs);
+	seq_printf(s, "last: 0x%02x 0x%02x 0x%02x\n",
+		   stats->last[SY24145_FAULT_SRC_STATUS],
+		   stats->last[SY24145_FAULT_SRC_STATUS_2],
+		   stats->last[SY24145_FAULT_SRC_DC]);
+	for (int i = 0; i < ARRAY_SIZE(sy24145_faults); ++i)
+		seq_printf(s, "%s: %u\n", sy24145_faults[i].name,
+			   stats->count[i]);
+	seq_printf(s, "events dropped: %u\n", sy24145->fault_dropped);
+
+	return 0;
+}
+
+DEFINE_SHOW_ATTRIBUTE(sy24145_faults);
+
+static int sy24145_fault_events_open(struct inode *inode, struct file *file)
+{
+	file->private_data = inode->i_private;
+	return stream_open(inode, file);
+}
+
+static ssize_t sy24145_fault_events_read(struct file *file, char __user *buf,
+					 size_t count, loff_t *ppos)
+{
+	struct sy24145 *sy24145 = file->private_data;
+	unsigned int copied = 0;
+	int ret = 0;
+
+	if (count < sizeof(struct sy24145_fault_event))
+		return -EINVAL;
+
+	ret = mutex_lock_interruptible(&sy24145->fault_read_lock);
+	if (ret < 0)
+		return ret;
+
+	while (kfifo_is_empty(&sy24145->fault_events)) {
+		mutex_unlock(&sy24145->fault_read_lock);
+
+		if (file->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+
+		ret = wait_event_interruptible(sy24145->fault_wait,
+				!kfifo_is_empty(&sy24145->fault_events));
+		if (ret < 0)
+			return ret;
+
+		ret = mutex_lock_interruptible(&sy24145->fault_read_lock);
+		if (ret < 0)
+			return ret;
+	}
+
+	ret = kfifo_to_user(&sy24145->fault_events, buf, count, &copied);
+	mutex_unlock(&sy24145->fault_read_lock);
+
+	return ret < 0 ? ret : copied;
+}
+
+static __poll_t sy24145_fault_events_poll(struct file *file, poll_table *wait)
+{
+	struct sy24145 *sy24145 = file->private_data;
+
+	poll_wait(file, &sy24145->fault_wait, wait);
+
+	if (!kfifo_is_empty(&sy24145->fault_events))
+		return EPOLLIN | EPOLLRDNORM;
+
+	return 0;
+}
+
+static const struct file_operations sy24145_fault_events_fops = {
+	.owner = THIS_MODULE,
+	.open = sy24145_fault_events_open,
+	.read = sy24145_fault_events_read,
+	.poll = sy24145_fault_events_poll,
+};
+
+static int sy24145_bus_latency_show(struct seq_file *s, void *data)
+{
+	static const char *const dirs[] = { "read", "write" };
+	struct sy24145 *sy24145 = s->private;
+	struct sy24145_bus_stats stats[SY24145_BUS_DIRS];
+
+	spin_lock(&sy24145->bus_stats_lock);
+	memcpy(stats, sy24145->bus_stats, sizeof(stats));
+	spin_unlock(&sy24145->bus_stats_lock);
+
+	for (int i = 0; i < SY24145_BUS_DIRS; ++i) {
+		seq_printf(s, "%s: count %llu bytes %llu errors %llu\n",
+			   dirs[i], stats[i].count, stats[i].bytes,
+			   stats[i].errors);
+		for (int b = 0; b < SY24145_LAT_BUCKETS; ++b)
+			seq_printf(s, "  %s%6lu us: %llu\n",
+				   b == SY24145_LAT_BUCKETS - 1 ? ">=" : "< ",
+				   b == SY24145_LAT_BUCKETS - 1 ?
+					   1UL << (b - 1) : 1UL << b,
+				   stats[i].hist[b]);
+	}
+
+	return 0;
+}
+
+static int sy24145_bus_latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, sy24145_bus_latency_show, inode->i_private);
+}
+
+/* Any write clears the histogram */
+static ssize_t sy24145_bus_latency_write(struct file *file,
+					 const char __user *buf, size_t count,
+					 loff_t *ppos)
+{
+	struct sy24145 *sy24145 =
+		((struct seq_file *)file->private_data)->private;
+
+	spin_lock(&sy24145->bus_stats_lock);
+	memset(sy24145->bus_stats, 0, sizeof(sy24145->bus_stats));
+	spin_unlock(&sy24145->bus_stats_lock);
+
+	return count;
+}
+
+static const struct file_operations sy24145_bus_latency_fops = {
+	.owner = THIS_MODULE,
+	.open = sy24145_bus_latency_open,
+	.read = seq_read,
+	.write = sy24145_bus_latency_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static int sy24145_op_stats_show(struct seq_file *s, void *data)
+{
+	struct sy24145 *sy24145 = s->private;
+	struct sy24145_op_stats stats[SY24145_NUM_OPS];
+
+	spin_lock(&sy24145->bus_stats_lock);
+	memcpy(stats, sy24145->op_stats, sizeof(stats));
+	spin_unlock(&sy24145->bus_stats_lock);
+
+	/* One op per line, key=value pairs for scripts */
+	for (int i = 0; i < SY24145_NUM_OPS; ++i)
+		seq_printf(s,
+			   "op=%s calls=%llu budget=%u over_budget=%llu transfers=%llu bytes=%llu last_transfers=%llu last_bytes=%llu max_transfers=%llu max_bytes=%llu\n",
+			   sy24145_op_names[i], stats[i].calls,
+			   sy24145_op_budgets[i], stats[i].over_budget,
+			   stats[i].transfers, stats[i].bytes,
+			   stats[i].last_transfers, stats[i].last_bytes,
+			   stats[i].max_transfers, stats[i].max_bytes);
+
+	return 0;
+}
+
+static int sy24145_op_stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, sy24145_op_stats_show, inode->i_private);
+}
+
+/* Any write clears the counters */
+static ssize_t sy24145_op_stats_write(struct file *file,
+				      const char __user *buf, size_t count,
+				      loff_t *ppos)
+{
+	struct sy24145 *sy24145 =
+		((struct seq_file *)file->private_data)->private;
+
+	spin_lock(&sy24145->bus_stats_lock);
+	memset(sy24145->op_stats, 0, sizeof(sy24145->op_stats));
+	spin_unlock(&sy24145->bus_stats_lock);
+
+	return count;
+}
+
+static const struct file_operations sy24145_op_stats_fops = {
+	.owner = THIS_MODULE,
+	.open = sy24145_op_stats_open,
+	.read = seq_read,
+	.write = sy24145_op_stats_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+static bool sy24145_script_reg_ok(unsigned int reg, unsigned int len)
+{
+	if (reg >= BQ0 && reg <= CHANNEL12_LOUDNESS)
+		return len == SY24145_COEF_BYTES;
+
+	return (sy24145_regs[reg].flags & SY24145_REG_W) &&
+	       len == sy24145_regs[reg].width;
+}
+
+/*
+ * "reg_script" takes records of { reg, len, len bytes of value }, the value
+ * least significant byte first, or five such 32 bit words for a coefficient
+ * register. len must be the register width. A script is checked as a whole
+ * before anything is sent, then the registers go out in a single transfer
+ * and the coefficient RAM in bursts after them, all under lock.
+ */
+static ssize_t sy24145_reg_script_write(struct file *file,
+					const char __user *user_buf,
+					size_t count, loff_t *ppos)
+{
+	struct sy24145 *sy24145 = file->private_data;
+	unsigned int num = 0;
+	uint8_t *script;
+	u8 *regs = NULL;
+	u32 *vals = NULL;
+	size_t pos = 0;
+	int ret = 0;
+
+	if (count > SY24145_SCRIPT_MAX)
+		return -EFBIG;
+
+	script = memdup_user(user_buf, count);
+	if (IS_ERR(script))
+		return PTR_ERR(script);
+
+	for (pos = 0; pos < count; pos += 2 + script[pos + 1]) {
+		unsigned int reg = 0;
+		unsigned int len = 0;
+
+		if (count - pos < 2 || count - pos - 2 < script[pos + 1]) {
+			ret = -EINVAL;
+			goto out;
+		}
+
+		reg = script[pos];
+		len = script[pos + 1];
+		if (!sy24145_script_reg_ok(reg, len)) {
+			ret = -EINVAL;
+			goto out;
+		}
+
+		/* The chip takes every value MSB first */
+		for (unsigned int i = 0; i < len; i += 4)
+			reverseArr(script + pos + 2 + i, min(len - i, 4U));
+
+		if (len != SY24145_COEF_BYTES)
+			num++;
+	}
+	if (num > SY24145_NUM_REGS) {
+		ret = -E2BIG;
+		goto out;
+	}
+
+	regs = kmalloc_array(num, sizeof(*regs), GFP_KERNEL);
+	vals = kmalloc_array(num, sizeof(*vals), GFP_KERNEL);
+	if (regs == NULL || vals == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
 
-	{
-		.name = "#8",
-		.reg_bits = 8,
-		.val_bits = 8,
-		.cache_type = REGCACHE_RBTREE,
-		.reg_defaults = sy24145_reg_defaults_8,
-		.num_reg_defaults = ARRAY_SIZE(sy24145_reg_defaults_8),
-		.readable_reg = sy24145_readable_reg,
-		.writeable_reg = sy24145_writeable_reg,
-	},
-	{
-		.name = "#16",
-		.reg_bits = 8,
-		.val_bits = 16,
-		.cache_type = REGCACHE_RBTREE,
-		.reg_defaults = sy24145_reg_defaults_16,
-		.num_reg_defaults = ARRAY_SIZE(sy24145_reg_defaults_16),
-		.readable_reg = sy24145_readable_reg,
-		.writeable_reg = sy24145_writeable_reg,
-	},
-	{
-		.name = "#24",
-		.reg_bits = 8,
-		.val_bits = 24,
-		.cache_type = REGCACHE_RBTREE,
-		.reg_defaults = sy24145_reg_defaults_24,
-		.num_reg_defaults = ARRAY_SIZE(sy24145_reg_defaults_24),
-		.readable_reg = sy24145_readable_reg,
-		.writeable_reg = sy24145_writeable_reg,
-	},
-	{
-		.name = "#32",
-		.reg_bits = 8,
-		.val_bits = 32,
-		.cache_type = REGCACHE_RBTREE,
-		.reg_defaults = sy24145_reg_defaults_32,
-		.num_reg_defaults = ARRAY_SIZE(sy24145_reg_defaults_32),
-		.readable_reg = sy24145_readable_reg,
-		.writeable_reg = sy24145_writeable_reg,
+	num = 0;
+	for (pos = 0; pos < count; pos += 2 + script[pos + 1]) {
+		if (script[pos + 1] == SY24145_COEF_BYTES)
+			continue;
+		regs[num] = script[pos];
+		vals[num++] = sy24145_be_to_val(script + pos + 2,
+						script[pos + 1]);
 	}
 
-};
+	mutex_lock(&sy24145->lock);
+	mutex_lock(&sy24145->coef_lock);
 
-static const struct i2c_device_id sy24145_id[] = {
-	{ "sy24145", 0 },
-	{},
-};
-MODULE_DEVICE_TABLE(i2c, sy24145_id);
+	ret = sy24145_reg_batch_write(sy24145, regs, vals, num);
 
-#ifdef CONFIG_OF
-static const struct of_device_id sy24145_of_ids[] = {
-	{
-		.compatible = "silergy,sy24145",
-	},
-	{}
-};
-MODULE_DEVICE_TABLE(of, sy24145_of_ids);
-#endif
+	for (pos = 0; pos < count && ret == 0; pos += 2 + script[pos + 1])
+		if (script[pos + 1] == SY24145_COEF_BYTES)
+			ret = sy24145_coef_stage(sy24145, script[pos], 1,
+						 script + pos + 2);
 
-#ifdef CONFIG_ACPI
-static const struct acpi_device_id sy24145_acpi_match[] = {
-	{ "SYL24145", 0 },
-	{},
+	/* Coefficient registers that fail stay dirty for the next flush */
+	if (ret == 0)
+		ret = __sy24145_coef_flush(sy24145);
+
+	sy24145_state_refresh(sy24145);
+
+	mutex_unlock(&sy24145->coef_lock);
+	mutex_unlock(&sy24145->lock);
+
+out:
+	kfree(vals);
+	kfree(regs);
+	kfree(script);
+	return ret < 0 ? ret : count;
+}
+
+static const struct file_operations sy24145_reg_script_fops = {
+	.owner = THIS_MODULE,
+	.open = simple_open,
+	.write = sy24145_reg_script_write,
 };
-MODULE_DEVICE_TABLE(acpi, sy24145_acpi_match);
-#endif
 
-static int sy24145_i2c_read(struct i2c_client *client, uint8_t reg, uint8_t len,
-			    uint8_t *val)
+/* Bytes of a register in the snapshot, 0 for registers that cannot be read */
+static unsigned int sy24145_snapshot_width(unsigned int reg)
 {
-	__u8 _reg = reg;
-	__u16 _len = len;
+	if (reg >= BQ0 && reg <= CHANNEL12_LOUDNESS)
+		return SY24145_COEF_BYTES;
+	if (!(sy24145_regs[reg].flags & SY24145_REG_R))
+		return 0;
+	return sy24145_regs[reg].width;
+}
 
-	uint8_t read_buf[20] = { 0 };
-	int err = 0;
+/*
+ * Volatile registers, registers not in the cache yet, such as the ones
+ * without a power-on default, and coefficient registers missing from the
+ * mirror.
+ */
+static bool sy24145_snapshot_from_bus(struct sy24145 *sy24145,
+				      unsigned int reg)
+{
+	if (reg >= BQ0 && reg <= CHANNEL12_LOUDNESS)
+		return !test_bit(reg - BQ0, sy24145->coef_valid);
+	return (sy24145_regs[reg].flags & SY24145_REG_IS_VOLATILE) ||
+	       !regcache_reg_cached(sy24145->regmap, reg);
+}
 
-	struct i2c_msg msgs[] = {
-		{
-			/* register number */
-			.addr = client->addr,
-			.flags = 0,
-			.len = sizeof(_reg),
-			.buf = &_reg,
-		},
-		{
-			/* read register contents */
-			.addr = client->addr,
-			.flags = I2C_M_RD,
-			.len = _len,
-			.buf = (__u8 *)read_buf,
-		},
+struct sy24145_snapshot {
+	size_t len;
+	u8 data[];
+};
 
-	};
+/*
+ * Every readable register as { reg, len, value }, the same records as
+ * "reg_script" takes. Cached registers and the coefficient mirror cost no
+ * bus access; everything else is read in a single transfer (or as few as
+ * the adapter takes), one burst per run of consecutive registers, and the
+ * coefficients read fill the mirror.
+ */
+static struct sy24145_snapshot *sy24145_snapshot(struct sy24145 *sy24145)
+{
+	struct i2c_client *client = sy24145->client;
+	const struct i2c_adapter_quirks *quirks = client->adapter->quirks;
+	struct sy24145_snapshot *snap = NULL;
+	unsigned int max_len = UINT_MAX;
+	u8 addr[SY24145_NUM_REGS];
+	struct i2c_msg *msgs = NULL;
+	unsigned int records = 0;
+	unsigned int last = 0;
+	size_t wire_len = 0;
+	size_t off = 0;
+	u8 *wire = NULL;
+	u8 *pos;
+	int num = 0;
+	int ret = 0;
 
-	err = i2c_transfer(client->adapter, msgs, ARRAY_SIZE(msgs));
-	if (err < 0) {
-		dev_err(&client->dev, "Error during reading reg 0x%X\n", _reg);
-		return err;
+	for (unsigned int reg = 0; reg < SY24145_NUM_REGS; ++reg) {
+		wire_len += sy24145_snapshot_width(reg);
+		records += sy24145_snapshot_width(reg) ? 1 : 0;
 	}
 
-	memcpy(val, read_buf, _len);
+	/* The registers as the chip sends them, MSB first */
+	wire = kmalloc(wire_len, GFP_KERNEL);
+	msgs = kmalloc_array(2 * records, sizeof(*msgs), GFP_KERNEL);
+	snap = kmalloc(struct_size(snap, data, 2 * records + wire_len),
+		       GFP_KERNEL);
+	if (wire == NULL || msgs == NULL || snap == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
 
-	dev_info(&client->dev, "Read register 0x%X complited successfully\n",
-		 _reg);
+	if (quirks && quirks->max_read_len)
+		max_len = quirks->max_read_len;
 
-	return 0;
-}
+	mutex_lock(&sy24145->coef_lock);
 
-static int sy24145_i2c_write(struct i2c_client *client, uint8_t reg,
-			     uint8_t len, uint8_t *val)
-{
-	__u8 _reg = reg;
-	__u16 _len = len;
+	for (unsigned int reg = 0; reg < SY24145_NUM_REGS; ++reg) {
+		unsigned int width = sy24145_snapshot_width(reg);
+		unsigned int val = 0;
 
-	uint8_t write_buf[21] = { 0 };
-	int err = 0;
+		if (width == 0)
+			continue;
 
-	struct i2c_msg msgs[] = {
-		{
-			.addr = client->addr,
-			.flags = 0,
-			.len = _len + 1,
-			.buf = write_buf,
-		},
-	};
+		if (!sy24145_snapshot_from_bus(sy24145, reg)) {
+			if (width == SY24145_COEF_BYTES) {
+				for (int i = 0; i < SY24145_COEF_WORDS; ++i)
+					sy24145_val_to_be(
+						sy24145->coef[reg - BQ0][i],
+						wire + off + i * 4, 4);
+			} else {
+				ret = regmap_read(sy24145->regmap, reg, &val);
+				if (ret < 0)
+					goto unlock;
+				sy24145_val_to_be(val, wire + off, width);
+			}
+		} else if (num && reg == last + 1 &&
+			   msgs[num - 1].len + width <= max_len) {
+			msgs[num - 1].len += width;
+			last = reg;
+		} else {
+			addr[reg] = reg;
+			msgs[num].addr = client->addr;
+			msgs[num].flags = 0;
+			msgs[num].len = 1;
+			msgs[num].buf = &addr[reg];
+			msgs[num + 1].addr = client->addr;
+			msgs[num + 1].flags = I2C_M_RD;
+			msgs[num + 1].len = width;
+			msgs[num + 1].buf = wire + off;
+			num += 2;
+			last = reg;
+		}
 
-	write_buf[0] = _reg;
-	// Старшими битами вперед
-	memcpy(write_buf + 1, val, _len);
+		off += width;
+	}
 
-	err = i2c_transfer(client->adapter, msgs, ARRAY_SIZE(msgs));
-	if (err < 0) {
-		dev_err(&client->dev, "Error during writing to reg 0x%X\n",
-			_reg);
-		return err;
+	if (num)
+		ret = sy24145_i2c_transfer_split(client, msgs, num, 2);
+	if (ret < 0)
+		goto unlock;
+
+	pos = snap->data;
+	off = 0;
+	for (unsigned int reg = 0; reg < SY24145_NUM_REGS; ++reg) {
+		unsigned int width = sy24145_snapshot_width(reg);
+
+		if (width == 0)
+			continue;
+
+		if (width == SY24145_COEF_BYTES &&
+		    !test_bit(reg - BQ0, sy24145->coef_valid)) {
+			for (int i = 0; i < SY24145_COEF_WORDS; ++i)
+				sy24145->coef[reg - BQ0][i] =
+					sy24145_be_to_val(wire + off + i * 4, 4);
+			set_bit(reg - BQ0, sy24145->coef_valid);
+		}
+
+		*pos++ = reg;
+		*pos++ = width;
+		memcpy(pos, wire + off, width);
+		for (unsigned int i = 0; i < width; i += 4)
+			reverseArr(pos + i, min(width - i, 4U));
+		pos += width;
+		off += width;
+	}
+	snap->len = pos - snap->data;
+
+unlock:
+	mutex_unlock(&sy24145->coef_lock);
+out:
+	kfree(msgs);
+	kfree(wire);
+	if (ret < 0) {
+		kfree(snap);
+		return ERR_PTR(ret);
 	}
+	return snap;
+}
+
+/* "registers" holds the snapshot taken at open */
+static int sy24145_registers_open(struct inode *inode, struct file *file)
+{
+	struct sy24145_snapshot *snap = sy24145_snapshot(inode->i_private);
 
-	dev_info(&client->dev,
-		 "Write to register 0x%X complited successfully\n", _reg);
+	if (IS_ERR(snap))
+		return PTR_ERR(snap);
 
+	file->private_data = snap;
 	return 0;
 }
 
-static int strToU8(char *str, int len, uint8_t *num)
+static ssize_t sy24145_registers_read(struct file *file, char __user *buf,
+				      size_t count, loff_t *ppos)
 {
-	int multiplier = 1;
-	uint8_t ret = 0;
+	struct sy24145_snapshot *snap = file->private_data;
 
-	for (int i = len - 1; i >= 0; --i) {
-		if (((str[i] >= 48) && (str[i] <= 57)) || (str[i] == '\n')) {
-			if (str[i] != '\n') {
-				ret += (str[i] - 48) * multiplier;
-				multiplier *= 10;
-			}
-		} else
-			return -1;
-	}
+	return simple_read_from_buffer(buf, count, ppos, snap->data,
+				       snap->len);
+}
 
-	*num = ret;
+static int sy24145_registers_release(struct inode *inode, struct file *file)
+{
+	kfree(file->private_data);
 	return 0;
 }
 
-static int getU8ArrFromString(const char *buf, size_t count, uint8_t *u8arr,
-			      const uint8_t size)
+static const struct file_operations sy24145_registers_fops = {
+	.owner = THIS_MODULE,
+	.open = sy24145_registers_open,
+	.read = sy24145_registers_read,
+	.llseek = default_llseek,
+	.release = sy24145_registers_release,
+};
+
+/* Cached registers away from their power-on value, no bus access */
+static int sy24145_registers_diff_show(struct seq_file *s, void *data)
 {
-	char *split_str[size];
-	char *isStr;
-	char *input = (char *)kmalloc(count, GFP_KERNEL);
-	int counter = 0;
+	struct sy24145 *sy24145 = s->private;
+	unsigned int val = 0;
 	int ret = 0;
-	uint8_t num = 0;
-	strcpy(input, buf);
-	isStr = strsep(&input, " ");
 
-	while (isStr != NULL) {
-		if (counter >= size) {
-			for (int i = 0; i < size; ++i)
-				kfree(split_str[i]);
-			kfree(input);
-			return -2;
-		}
-		split_str[counter] = (char *)kmalloc(strlen(isStr), GFP_KERNEL);
-		strcpy(split_str[counter], isStr);
-		isStr = strsep(&input, " ");
-		counter++;
-	}
+	for (unsigned int reg = 0; reg < SY24145_NUM_REGS; ++reg) {
+		const struct sy24145_reg_desc *desc = &sy24145_regs[reg];
+		int digits = desc->width * 2;
 
-	if (counter != size) {
-		for (int i = 0; i < counter; ++i)
-			kfree(split_str[i]);
-		kfree(input);
-		return -2;
-	}
+		if ((desc->flags & (SY24145_REG_HAS_DEFAULT |
+				    SY24145_REG_IS_VOLATILE)) !=
+		    SY24145_REG_HAS_DEFAULT)
+			continue;
 
-	for (int i = 0; i < size; ++i) {
-		if (strToU8(split_str[i], strlen(split_str[i]), &num) == 0) {
-			u8arr[i] = num;
-		} else {
-			for (int i = 0; i < size; ++i)
-				kfree(split_str[i]);
-			kfree(input);
-			return -1;
-		}
+		ret = regmap_read(sy24145->regmap, reg, &val);
+		if (ret < 0)
+			return ret;
+		if (val != desc->def)
+			seq_printf(s, "0x%02x: 0x%0*x (default 0x%0*x)\n", reg,
+				   digits, val, digits, desc->def);
 	}
 
-	for (int i = 0; i < size; ++i)
-		kfree(split_str[i]);
-	kfree(input);
 	return 0;
 }
+DEFINE_SHOW_ATTRIBUTE(sy24145_registers_diff);
 
-static int reverseArr(uint8_t *arr, const int size)
+static void sy24145_debugfs_remove(void *data)
 {
-	for (int i = 0; i < size / 2; ++i) {
-		uint8_t temp = arr[i];
-		arr[i] = arr[size - 1 - i];
-		arr[size - 1 - i] = temp;
-	}
-	return 0;
+	struct sy24145 *sy24145 = data;
+
+	debugfs_remove_recursive(sy24145->debugfs);
 }
 
-ssize_t sy24145_sys_show_sample_rate(struct device *dev,
-				     struct device_attribute *attr, char *buf)
+static int sy24145_debugfs_init(struct sy24145 *sy24145)
 {
-	struct sy24145 *sy24145 = dev_get_drvdata(dev);
-	int ret = 0;
-	ret = sprintf(buf, "%u\n", sample_rate_g);
-	return ret;
-}
+	struct device *dev = &sy24145->client->dev;
+	char name[32];
 
-static DEVICE_ATTR(sample_rate, S_IRUSR, sy24145_sys_show_sample_rate, NULL);
+	snprintf(name, sizeof(name), "sy24145-%s", dev_name(dev));
+	sy24145->debugfs = debugfs_create_dir(name, NULL);
 
-ssize_t sy24145_sys_show_master_volume(struct device *dev,
-				       struct device_attribute *attr, char *buf)
+	debugfs_create_bool("coef_readback", 0644, sy24145->debugfs,
+			    &sy24145->coef_readback);
+	debugfs_create_file("coef_load", 0444, sy24145->debugfs, sy24145,
+			    &sy24145_coef_load_fops);
+	debugfs_create_file("preset_switch", 0444, sy24145->debugfs, sy24145,
+			    &sy24145_preset_switch_fops);
+	debugfs_create_file("pm", 0444, sy24145->debugfs, sy24145,
+			    &sy24145_pm_fops);
+	debugfs_create_file("bus_latency", 0644, sy24145->debugfs, sy24145,
+			    &sy24145_bus_latency_fops);
+	debugfs_create_file("op_stats", 0644, sy24145->debugfs, sy24145,
+			    &sy24145_op_stats_fops);
+	debugfs_create_file("eq", 0444, sy24145->debugfs, sy24145,
+			    &sy24145_eq_fops);
+	debugfs_create_file("hw_params", 0444, sy24145->debugfs, sy24145,
+			    &sy24145_hw_params_fops);
+	debugfs_create_file("faults", 0444, sy24145->debugfs, sy24145,
+			    &sy24145_faults_fops);
+	debugfs_create_file("fault_events", 0400, sy24145->debugfs, sy24145,
+			    &sy24145_fault_events_fops);
+	debugfs_create_file("reg_script", 0200, sy24145->debugfs, sy24145,
+			    &sy24145_reg_script_fops);
+	debugfs_create_file("registers", 0400, sy24145->debugfs, sy24145,
+			    &sy24145_registers_fops);
+	debugfs_create_file("registers_diff", 0444, sy24145->debugfs, sy24145,
+			    &sy24145_registers_diff_fops);
+
+	return devm_add_action_or_reset(dev, sy24145_debugfs_remove, sy24145);
+}
+
+static int sy24145_regmap_init(struct sy24145 *sy24145)
 {
-	struct sy24145 *sy24145 = dev_get_drvdata(dev);
-	uint32_t master_volume = 0;
-	int32_t retVolume = 0;
-	uint8_t reg = MASTER_VOLUME;
-	int ret = 0;
+	struct regmap_config config = sy24145_regmap_config;
+	struct reg_default *defaults;
+	size_t num = 0;
 
-	ret = regmap_read(sy24145->regmap, reg, &master_volume);
-	if (ret == 0) {
-		if ((master_volume >= 0) && (master_volume <= 2))
-			ret = sprintf(buf, "0\n");
-		else {
-			retVolume = -252 + master_volume - 0x3;
-			ret = sprintf(buf, "%d\n", retVolume);
-		}
-	} else
-		ret = sprintf(buf, "1\n");
+	defaults = kcalloc(SY24145_NUM_REGS, sizeof(*defaults), GFP_KERNEL);
+	if (defaults == NULL)
+		return -ENOMEM;
 
-	return ret;
-}
+	/* Volatile registers are always read back, their default is unused */
+	for (unsigned int reg = 0; reg < SY24145_NUM_REGS; ++reg) {
+		if ((sy24145_regs[reg].flags &
+		     (SY24145_REG_HAS_DEFAULT | SY24145_REG_IS_VOLATILE)) !=
+		    SY24145_REG_HAS_DEFAULT)
+			continue;
+		defaults[num].reg = reg;
+		defaults[num].def = sy24145_regs[reg].def;
+		num++;
+	}
 
-static DEVICE_ATTR(master_volume, S_IRUSR, sy24145_sys_show_master_volume,
-		   NULL);
+	config.reg_defaults = defaults;
+	config.num_reg_defaults = num;
+	config.lock = sy24145_regmap_lock;
+	config.unlock = sy24145_regmap_unlock;
+	config.lock_arg = sy24145;
 
-static struct attribute *sy24145_attributes_sample_rate[] = {
-	&dev_attr_sample_rate.attr,
-	NULL,
-};
+	/* regcache keeps its own copy of the defaults */
+	sy24145->regmap = devm_regmap_init(&sy24145->client->dev, NULL,
+					   sy24145, &config);
+	kfree(defaults);
 
-static struct attribute *sy24145_attributes_master_volume[] = {
-	&dev_attr_master_volume.attr,
-	NULL,
-};
+	return PTR_ERR_OR_ZERO(sy24145->regmap);
+}
 
-static const struct attribute_group sy24145_sample_rate_group = {
-	.attrs = sy24145_attributes_sample_rate,
-};
+static void sy24145_sysfs_remove(void *data)
+{
+	struct sy24145 *sy24145 = data;
 
-static const struct attribute_group sy24145_master_volume_group = {
-	.attrs = sy24145_attributes_master_volume,
-};
+	sysfs_remove_groups(&sy24145->client->dev.kobj, sy24145_groups);
+}
 
-static const struct attribute_group *sy24145_groups[] = {
-	&sy24145_sample_rate_group,
-	&sy24145_master_volume_group,
-	NULL,
-};
+/*
+ * Set up a zeroed sy24145 for i2c: the defaults parse_dt may override, the
+ * locks, the works and the regmap. Nothing reaches the chip yet.
+ */
+static int sy24145_setup(struct sy24145 *sy24145, struct i2c_client *i2c)
+{
+	sy24145->client = i2c;
+	sy24145->sample_rate = 44100;
+	sy24145->coef_fw_name = SY24145_COEF_FW_NAME;
+	sy24145->standby_delay_ms = SY24145_STANDBY_DELAY_MS;
+	sy24145->fault_monitor_pin = -1;
+	mutex_init(&sy24145->lock);
+	mutex_init(&sy24145->regmap_lock);
+	spin_lock_init(&sy24145->bus_stats_lock);
+	mutex_init(&sy24145->coef_lock);
+	INIT_WORK(&sy24145->preset_work, sy24145_preset_work);
+	INIT_WORK(&sy24145->init_work, sy24145_init_work);
+	INIT_WORK(&sy24145->eq_work, sy24145_eq_work);
+	init_completion(&sy24145->init_done);
+	mutex_init(&sy24145->fault_read_lock);
+	init_waitqueue_head(&sy24145->fault_wait);
+	INIT_KFIFO(sy24145->fault_events);
+
+	i2c_set_clientdata(i2c, sy24145);
+
+	return sy24145_regmap_init(sy24145);
+}
 
 static int sy24145_i2c_probe(struct i2c_client *i2c)
 {
 	struct sy24145 *sy24145;
+	struct sy24145_op_mark mark;
 	int ret = 0;
 	int dev_id = 0;
 
@@ -887,37 +3955,208 @@ static int sy24145_i2c_probe(struct i2c_client *i2c)
 	if (sy24145 == NULL)
 		return -ENOMEM;
 
-	sy24145->client = i2c;
-
-	i2c_set_clientdata(i2c, sy24145);
+	ret = sy24145_setup(sy24145, i2c);
+	if (ret < 0)
+		return ret;
 
-	sy24145->regmap = devm_regmap_init_i2c(i2c, sy24145_regmap_config);
-	if (IS_ERR(sy24145->regmap))
-		return PTR_ERR(sy24145->regmap);
+	sy24145_op_begin(sy24145, &mark);
 
 	ret = regmap_read(sy24145->regmap, DEVICE_ID, &dev_id);
-	if (ret == 0)
-		dev_info(&i2c->dev, "sy24145 device id = 0x%x", dev_id);
-	ret = devm_snd_soc_register_component(
-		&i2c->dev, &sy24145_component_driver, &sy24145_dai, 1);
+	if (ret < 0) {
+		dev_err(&i2c->dev, "Failed to read device id, %d\n", ret);
+		return ret;
+	}
+	dev_info(&i2c->dev, "sy24145 device id = 0x%x", dev_id);
 
 	ret = sy24145_parse_dt_property(i2c, sy24145);
+	if (ret < 0)
+		return ret;
+
+	ret = sy24145_set_configuration_settings(sy24145);
+	if (ret < 0) {
+		dev_err(&i2c->dev, "Failed to configure amplifier, %d\n", ret);
+		return ret;
+	}
+	ret = regmap_read(sy24145->regmap, PLL_STATUS, &sy24145->pll_status);
+	if (ret < 0)
+		return ret;
+	sy24145_op_end(sy24145, SY24145_OP_PROBE, &mark);
 
-	sy24145_set_configuration_settings(sy24145);
+	mutex_lock(&sy24145->lock);
+	sy24145_state_refresh(sy24145);
+	mutex_unlock(&sy24145->lock);
 
-	ret = sysfs_create_groups(&i2c->dev.kobj, sy24145_groups);
+	ret = sy24145_debugfs_init(sy24145);
+	if (ret < 0)
+		return ret;
+
+	if (i2c->irq > 0) {
+		ret = devm_request_threaded_irq(&i2c->dev, i2c->irq, NULL,
+						sy24145_fault_irq, IRQF_ONESHOT,
+						"sy24145-fault", sy24145);
+		if (ret < 0) {
+			dev_err(&i2c->dev, "Failed to request fault irq, %d\n",
+				ret);
+			return ret;
+		}
+	}
+
+	/* Runs after the component is gone, nothing can requeue the works */
+	ret = devm_add_action_or_reset(&i2c->dev, sy24145_coef_release, sy24145);
 	if (ret < 0)
+		return ret;
+
+	/* Active now, standby once no stream ran for standby_delay_ms */
+	pm_runtime_set_autosuspend_delay(&i2c->dev, sy24145->standby_delay_ms);
+	pm_runtime_use_autosuspend(&i2c->dev);
+	pm_runtime_set_active(&i2c->dev);
+	pm_runtime_mark_last_busy(&i2c->dev);
+	ret = devm_pm_runtime_enable(&i2c->dev);
+	if (ret < 0)
+		return ret;
+
+	/* The tuning load is the slow part, finish it off the probe path */
+	queue_work(system_unbound_wq, &sy24145->init_work);
+
+	ret = sysfs_create_groups(&i2c->dev.kobj, sy24145_groups);
+	if (ret < 0) {
 		dev_err(&i2c->dev, "Failed to create sysfs group, %d\n", ret);
-	sample_rate_g = 44100;
+		return ret;
+	}
+	ret = devm_add_action_or_reset(&i2c->dev, sy24145_sysfs_remove, sy24145);
+	if (ret < 0)
+		return ret;
+
+	/* Last, streams may open as soon as the component is registered */
+	ret = devm_snd_soc_register_component(
+		&i2c->dev, &sy24145_component_driver, &sy24145_dai, 1);
+	if (ret < 0)
+		dev_err(&i2c->dev, "Failed to register component, %d\n", ret);
+	return ret;
+}
+
+static int sy24145_suspend(struct device *dev)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+	int ret = 0;
+
+	/* The fault thread and the works use the bus without the regmap */
+	if (sy24145->client->irq > 0)
+		disable_irq(sy24145->client->irq);
+	flush_work(&sy24145->init_work);
+	flush_work(&sy24145->preset_work);
+	flush_work(&sy24145->eq_work);
+
+	ret = regmap_update_bits(sy24145->regmap, PWM_CONTROL,
+				 PWM_CONTROL_SHUTDOWN_MASK,
+				 PWM_CONTROL_SHUTDOWN_ENTER);
+	if (ret < 0) {
+		if (sy24145->client->irq > 0)
+			enable_irq(sy24145->client->irq);
+		return ret;
+	}
+
+	/* The chip may lose power, replay the cache on resume */
+	regcache_cache_only(sy24145->regmap, true);
+	regcache_mark_dirty(sy24145->regmap);
+
+	return 0;
+}
+
+/*
+ * Restore the registers that differ from their power-on default while the
+ * outputs are still shut down, then the coefficient RAM in bursts, and only
+ * then leave shutdown.
+ */
+static int sy24145_resume(struct device *dev)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+	struct sy24145_pm_stats *stats = &sy24145->pm_stats;
+	ktime_t start = ktime_get();
+	int ret = 0;
+
+	regcache_cache_only(sy24145->regmap, false);
+
+	mutex_lock(&sy24145->coef_lock);
+	sy24145->coef_defer = true;
+	ret = regcache_sync(sy24145->regmap);
+	sy24145->coef_defer = false;
+	if (ret == 0) {
+		bitmap_or(sy24145->coef_dirty, sy24145->coef_dirty,
+			  sy24145->coef_valid, SY24145_NUM_COEF_REGS);
+		ret = __sy24145_coef_flush(sy24145);
+	}
+	mutex_unlock(&sy24145->coef_lock);
+
+	if (ret == 0)
+		ret = regmap_update_bits(sy24145->regmap, PWM_CONTROL,
+					 PWM_CONTROL_SHUTDOWN_MASK,
+					 PWM_CONTROL_SHUTDOWN_EXIT);
+	if (sy24145->client->irq > 0)
+		enable_irq(sy24145->client->irq);
+	if (ret < 0) {
+		dev_err(dev, "Failed to restore registers, %d\n", ret);
+		regcache_mark_dirty(sy24145->regmap);
+		return ret;
+	}
+
+	stats->resumes++;
+	stats->resume_last_us = ktime_us_delta(ktime_get(), start);
+	stats->resume_max_us = max(stats->resume_max_us, stats->resume_last_us);
+
+	return 0;
+}
+
+static int sy24145_runtime_suspend(struct device *dev)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+	int ret = 0;
+
+	/* Registers and coefficients are retained in standby */
+	ret = regmap_update_bits(sy24145->regmap, PWM_CONTROL,
+				 PWM_CONTROL_STANDBY_MASK,
+				 PWM_CONTROL_STANDBY_ENTER);
+	if (ret == 0)
+		sy24145->pm_stats.standby_enters++;
+
 	return ret;
 }
 
+static int sy24145_runtime_resume(struct device *dev)
+{
+	struct sy24145 *sy24145 = dev_get_drvdata(dev);
+	struct sy24145_pm_stats *stats = &sy24145->pm_stats;
+	ktime_t start = ktime_get();
+	int ret = 0;
+
+	ret = regmap_update_bits(sy24145->regmap, PWM_CONTROL,
+				 PWM_CONTROL_STANDBY_MASK,
+				 PWM_CONTROL_STANDBY_EXIT);
+	if (ret < 0)
+		return ret;
+
+	stats->wakes++;
+	stats->wake_last_us = ktime_us_delta(ktime_get(), start);
+	stats->wake_max_us = max(stats->wake_max_us, stats->wake_last_us);
+	WRITE_ONCE(sy24145->wake_start, start);
+	WRITE_ONCE(sy24145->wake_pending, true);
+
+	return 0;
+}
+
+static const struct dev_pm_ops sy24145_pm_ops = {
+	SYSTEM_SLEEP_PM_OPS(sy24145_suspend, sy24145_resume)
+	RUNTIME_PM_OPS(sy24145_runtime_suspend, sy24145_runtime_resume, NULL)
+};
+
 static struct i2c_driver sy24145_driver = {
 	.driver		= {
 		.name	= "sy24145",
 		.owner  = THIS_MODULE,
 		.of_match_table = of_match_ptr(sy24145_of_ids),
 		.acpi_match_table = ACPI_PTR(sy24145_acpi_match),
+		.pm = pm_ptr(&sy24145_pm_ops),
+		.probe_type = PROBE_PREFER_ASYNCHRONOUS,
 	},
 	.probe		= sy24145_i2c_probe,
 	.id_table   = sy24145_id,
@@ -925,5 +4164,10 @@ static struct i2c_driver sy24145_driver = {
 
 module_i2c_driver(sy24145_driver);
 
+MODULE_FIRMWARE(SY24145_COEF_FW_NAME);
 MODULE_DESCRIPTION("sy24145 device driver");
-MODULE_LICENSE("GPL");
\ No newline at end of file
+MODULE_LICENSE("GPL");
+
+#if IS_ENABLED(CONFIG_SND_SOC_SY24145_KUNIT_TEST)
+#include "sy24145_test.c"
+#endif
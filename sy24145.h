@@ -188,6 +188,18 @@
 #define MDRC_CHECKSUM 0x9B
 #define PBQ_CH2_CHECKSUM 0x9C
 
+/* Coefficient RAM (BQ0 - CHANNEL12_LOUDNESS): five 32-bit words per register */
+#define SY24145_COEF_WORDS 5
+#define SY24145_COEF_BYTES (SY24145_COEF_WORDS * 4)
+#define SY24145_NUM_COEF_REGS (CHANNEL12_LOUDNESS - BQ0 + 1)
+
+/* Regmap addresses of the coefficient words, placed above the physical map */
+#define SY24145_COEF_VREG_BASE 0x100
+#define SY24145_COEF_VREG(reg, word) \
+	(SY24145_COEF_VREG_BASE + ((reg) - BQ0) * SY24145_COEF_WORDS + (word))
+#define SY24145_MAX_REGISTER \
+	SY24145_COEF_VREG(CHANNEL12_LOUDNESS, SY24145_COEF_WORDS - 1)
+
 #define CMD_WRITE_ADDR_SEL_PD 0x54
 #define CMD_WRITE_ADDR_SEL_PU 0x56
 
@@ -224,18 +236,22 @@
 
 /* System control register 1 (0x03) */
 #define I2C_ACCESS_COEF_RAM_EN_SHFT 0
+#define I2C_ACCESS_COEF_RAM_EN_MASK (0x1 << I2C_ACCESS_COEF_RAM_EN_SHFT)
 #define IACRE_DAP_ACCESS (0x0 << I2C_ACCESS_COEF_RAM_EN_SHFT)
 #define IACRE_I2C_ACCESS (0x1 << I2C_ACCESS_COEF_RAM_EN_SHFT)
 
 #define RAM_CH2_EN_SHFT 1
+#define RAM_CH2_EN_MASK (0x1 << RAM_CH2_EN_SHFT)
 #define RCE2_I2C_WR_ON (0x1 << RAM_CH2_EN_SHFT)
 #define RCE2_I2C_WR_OFF (0x0 << RAM_CH2_EN_SHFT)
 
 #define RAM_CH1_EN_SHFT 2
+#define RAM_CH1_EN_MASK (0x1 << RAM_CH1_EN_SHFT)
 #define RCE1_I2C_WR_ON (0x1 << RAM_CH1_EN_SHFT)
 #define RCE1_I2C_WR_OFF (0x0 << RAM_CH1_EN_SHFT)
 
 #define DSP_FADE_EN_SHFT 3
+#define DSP_FADE_EN_MASK (0x1 << DSP_FADE_EN_SHFT)
 #define DFER_FADE_DIS (0x0 << DSP_FADE_EN_SHFT)
 #define DFER_FADE_EN (0x1 << DSP_FADE_EN_SHFT)
 
@@ -366,7 +382,7 @@ int get_delay_line_lgth(int length)
 #define I2S_VBITS_16 (0x3 << I2S_VBITS_SHFT)
 
 #define I2S_FMT_SHFT 2
-#define I2S_FMT_MASK (0x2 << I2S_FMT_SHFT)
+#define I2S_FMT_MASK (0x3 << I2S_FMT_SHFT)
 #define I2S_FMT_I2S (0x0 << I2S_FMT_SHFT)
 #define I2S_FMT_LJ (0x1 << I2S_FMT_SHFT)
 #define I2S_FMT_RJ (0x2 << I2S_FMT_SHFT)
@@ -395,6 +411,7 @@ int get_delay_line_lgth(int length)
 #define CH1_EN (0x1 << CH1_EN_SHFT)
 
 #define DSP_FADE_TIME_SEL_SHFT 3
+#define DSP_FADE_TIME_SEL_MASK (0x3 << DSP_FADE_TIME_SEL_SHFT)
 #define DSP_FADE_TIME_SEL_X1 (0x0 << DSP_FADE_TIME_SEL_SHFT)
 #define DSP_FADE_TIME_SEL_X2 (0x1 << DSP_FADE_TIME_SEL_SHFT)
 #define DSP_FADE_TIME_SEL_X4 (0x2 << DSP_FADE_TIME_SEL_SHFT)
@@ -405,6 +422,7 @@ int get_delay_line_lgth(int length)
 /* Monitor Pin configured Register 1 (0x17) */
 
 #define MONITOR0_CFG_SHFT 0
+#define MONITOR0_CFG_MASK (0xF << MONITOR0_CFG_SHFT)
 #define MONITOR0_CFG_I2S_DATA_OUT (0x0 << MONITOR0_CFG_SHFT)
 #define MONITOR0_CFG_PWM_OUT_A (0x1 << MONITOR0_CFG_SHFT)
 #define MONITOR0_CFG_PWM_OUT_B (0x2 << MONITOR0_CFG_SHFT)
@@ -426,19 +444,23 @@ int get_delay_line_lgth(int length)
 #define SDA_OUT_LOC_BEHIND (0x0 << SDA_OUT_LOC_SHFT)
 
 #define MONITOR2_EN_SHFT 5
+#define MONITOR2_EN_MASK (0x1 << MONITOR2_EN_SHFT)
 #define MONITOR2_DIS (0x0 << MONITOR2_EN_SHFT)
 #define MONITOR2_EN (0x1 << MONITOR2_EN_SHFT)
 
 #define MONITOR1_EN_SHFT 6
+#define MONITOR1_EN_MASK (0x1 << MONITOR1_EN_SHFT)
 #define MONITOR1_DIS (0x0 << MONITOR1_EN_SHFT)
 #define MONITOR1_EN (0x1 << MONITOR1_EN_SHFT)
 
 #define MONITOR0_EN_SHFT 7
+#define MONITOR0_EN_MASK (0x1 << MONITOR0_EN_SHFT)
 #define MONITOR0_DIS (0x0 << MONITOR0_EN_SHFT)
 #define MONITOR0_EN (0x1 << MONITOR0_EN_SHFT)
 
 /* Monitor Pin configured Register 2 (0x18) */
 #define MONITOR2_CFG_SHFT 0
+#define MONITOR2_CFG_MASK (0xF << MONITOR2_CFG_SHFT)
 #define MONITOR2_CFG_I2S_DATA_OUT (0x0 << MONITOR2_CFG_SHFT)
 #define MONITOR2_CFG_PWM_OUT_A (0x1 << MONITOR2_CFG_SHFT)
 #define MONITOR2_CFG_PWM_OUT_B (0x2 << MONITOR2_CFG_SHFT)
@@ -456,6 +478,7 @@ int get_delay_line_lgth(int length)
 #define MONITOR2_CFG_FAULT_OC (0xF << MONITOR2_CFG_SHFT)
 
 #define MONITOR1_CFG_SHFT 4
+#define MONITOR1_CFG_MASK (0xF << MONITOR1_CFG_SHFT)
 #define MONITOR1_CFG_I2S_DATA_OUT (0x0 << MONITOR1_CFG_SHFT)
 #define MONITOR1_CFG_PWM_OUT_A (0x1 << MONITOR1_CFG_SHFT)
 #define MONITOR1_CFG_PWM_OUT_B (0x2 << MONITOR1_CFG_SHFT)
@@ -0,0 +1,1167 @@
+// SPDX-License-Identifier: GPL-2.0
+/*
+ * KUnit tests for the sy24145 driver, included at the end of sy24145.c.
+ *
+ * The driver runs unmodified on top of a simulated chip behind a fake I2C
+ * adapter. The chip keeps every register in RAM with its sy24145_regs width
+ * and power-on value, auto-increments through consecutive registers like the
+ * real part and counts the transfers, messages and bytes it is sent. It NAKs
+ * reads of registers that are not readable and writes of registers that are
+ * not writable, latches ERROR_STATUS until it is written with 0 bits and
+ * keeps the checksum registers as the XOR of their bank. A checksum error
+ * can be injected into the next writes of a bank. Every
+ * case prints the traffic of the operations it drives as
+ *   op=<name> transfers=<n> msgs=<n> bytes=<n>
+ * and fails when an operation exceeds its sy24145_op_budgets entry.
+ */
+#include <kunit/test.h>
+
+struct sy24145_test_chip {
+	struct i2c_adapter adap;
+	struct i2c_adapter_quirks quirks;
+	bool added;
+	u8 regs[SY24145_NUM_REGS][SY24145_COEF_BYTES];
+	/* Writes to the bank still to be corrupted, each latches its flag */
+	unsigned int corrupt[SY24145_NUM_BANKS];
+	unsigned int ptr;
+	unsigned int transfers;
+	unsigned int msgs;
+	unsigned int bytes;
+};
+
+struct sy24145_test {
+	struct sy24145_test_chip chip;
+	struct i2c_client *client;
+	struct sy24145 *sy24145;
+	struct snd_soc_component component;
+	struct snd_soc_dai dai;
+	/* A second instance on its own adapter, torn down with this one */
+	struct sy24145_test *peer;
+	/* Chip counters at sy24145_test_mark() */
+	unsigned int transfers;
+	unsigned int msgs;
+	unsigned int bytes;
+};
+
+static unsigned int sy24145_test_width(unsigned int reg)
+{
+	return sy24145_regs[reg].width ?: 1;
+}
+
+static bool sy24145_test_is_coef(unsigned int reg)
+{
+	return reg >= BQ0 && reg <= CHANNEL12_LOUDNESS;
+}
+
+static bool sy24145_test_readable(unsigned int reg)
+{
+	return sy24145_test_is_coef(reg) ||
+	       (sy24145_regs[reg].flags & SY24145_REG_R);
+}
+
+static bool sy24145_test_writable(unsigned int reg)
+{
+	return sy24145_test_is_coef(reg) ||
+	       (sy24145_regs[reg].flags & SY24145_REG_W);
+}
+
+/* The checksum of a bank as this model computes it, XOR of every word */
+static void sy24145_test_checksum(struct sy24145_test_chip *chip,
+				  unsigned int bank)
+{
+	const struct sy24145_coef_bank *b = &sy24145_coef_banks[bank];
+	u32 sum = 0;
+
+	for (unsigned int reg = b->first; reg <= b->last; ++reg)
+		for (int i = 0; i < SY24145_COEF_WORDS; ++i)
+			sum ^= sy24145_be_to_val(chip->regs[reg] + i * 4, 4);
+
+	if (bank == SY24145_BANK_PBQ) {
+		sy24145_val_to_be(sum, chip->regs[PBQ_CHECKSUM], 4);
+		sy24145_val_to_be(sum, chip->regs[PBQ_CH2_CHECKSUM], 4);
+	} else {
+		sy24145_val_to_be(sum, chip->regs[MDRC_CHECKSUM], 4);
+	}
+}
+
+/* Registers first..last were just written */
+static void sy24145_test_written(struct sy24145_test_chip *chip,
+				 unsigned int first, unsigned int last)
+{
+	for (int i = 0; i < SY24145_NUM_BANKS; ++i) {
+		const struct sy24145_coef_bank *b = &sy24145_coef_banks[i];
+
+		if (first > b->last || last < b->first)
+			continue;
+
+		if (chip->corrupt[i]) {
+			chip->corrupt[i]--;
+			chip->regs[max(first, b->first)][SY24145_COEF_BYTES - 1] ^=
+				1;
+			chip->regs[ERROR_STATUS][0] |= b->error;
+		}
+		sy24145_test_checksum(chip, i);
+	}
+}
+
+/* A message writes the register number, then data from there on */
+static int sy24145_test_xfer(struct i2c_adapter *adap, struct i2c_msg *msgs,
+			     int num)
+{
+	struct sy24145_test_chip *chip = i2c_get_adapdata(adap);
+
+	chip->transfers++;
+
+	for (int i = 0; i < num; ++i) {
+		bool read = msgs[i].flags & I2C_M_RD;
+		u8 *buf = msgs[i].buf;
+		unsigned int len = msgs[i].len;
+		unsigned int first = 0;
+		unsigned int off = 0;
+
+		chip->msgs++;
+		chip->bytes += len;
+
+		if (!read) {
+			if (len == 0)
+				return -EIO;
+			chip->ptr = *buf++;
+			len--;
+		}
+		first = chip->ptr;
+
+		for (unsigned int j = 0; j < len; ++j) {
+			if (chip->ptr >= SY24145_NUM_REGS)
+				return -EIO;
+			/* The chip NAKs registers it does not take */
+			if (read ? !sy24145_test_readable(chip->ptr) :
+				   !sy24145_test_writable(chip->ptr))
+				return -ENXIO;
+			if (read)
+				buf[j] = chip->regs[chip->ptr][off];
+			else if (chip->ptr == ERROR_STATUS)
+				chip->regs[chip->ptr][off] &= buf[j];
+			else
+				chip->regs[chip->ptr][off] = buf[j];
+			if (++off == sy24145_test_width(chip->ptr)) {
+				off = 0;
+				chip->ptr++;
+			}
+		}
+
+		if (!read && len)
+			sy24145_test_written(chip, first, chip->ptr - 1);
+	}
+
+	return num;
+}
+
+static u32 sy24145_test_func(struct i2c_adapter *adap)
+{
+	return I2C_FUNC_I2C;
+}
+
+static const struct i2c_algorithm sy24145_test_algo = {
+	.master_xfer = sy24145_test_xfer,
+	.functionality = sy24145_test_func,
+};
+
+static unsigned int sy24145_test_reg(struct sy24145_test *t, unsigned int reg)
+{
+	return sy24145_be_to_val(t->chip.regs[reg], sy24145_test_width(reg));
+}
+
+static void sy24145_test_set_reg(struct sy24145_test *t, unsigned int reg,
+				 unsigned int val)
+{
+	sy24145_val_to_be(val, t->chip.regs[reg], sy24145_test_width(reg));
+}
+
+static void sy24145_test_mark(struct sy24145_test *t)
+{
+	t->transfers = t->chip.transfers;
+	t->msgs = t->chip.msgs;
+	t->bytes = t->chip.bytes;
+}
+
+/* Print the traffic since sy24145_test_mark(), returns the transfers */
+static unsigned int sy24145_test_report(struct kunit *test, const char *op)
+{
+	struct sy24145_test *t = test->priv;
+	unsigned int transfers = t->chip.transfers - t->transfers;
+
+	kunit_info(test, "op=%s transfers=%u msgs=%u bytes=%u\n", op,
+		   transfers, t->chip.msgs - t->msgs, t->chip.bytes - t->bytes);
+	sy24145_test_mark(t);
+	return transfers;
+}
+
+/* The driver's own accounting must agree with the chip and the budget */
+static void sy24145_test_check_op(struct kunit *test, unsigned int op,
+				  unsigned int transfers)
+{
+	struct sy24145 *sy24145 = ((struct sy24145_test *)test->priv)->sy24145;
+
+	KUNIT_EXPECT_EQ(test, sy24145->op_stats[op].last_transfers, transfers);
+	KUNIT_EXPECT_LE(test, transfers, sy24145_op_budgets[op]);
+	KUNIT_EXPECT_EQ(test, sy24145->op_stats[op].over_budget, 0);
+}
+
+static int sy24145_test_put(struct sy24145_test *t, const char *name,
+			    long val)
+{
+	const struct snd_kcontrol_new *tmpl = NULL;
+	struct snd_ctl_elem_value *ucontrol;
+	struct snd_kcontrol *kctl;
+	int ret = 0;
+
+	for (int i = 0; i < ARRAY_SIZE(sy24145_controls); ++i)
+		if (!strcmp(sy24145_controls[i].name, name))
+			tmpl = &sy24145_controls[i];
+	if (tmpl == NULL)
+		return -ENOENT;
+
+	ucontrol = kzalloc(sizeof(*ucontrol), GFP_KERNEL);
+	kctl = snd_ctl_new1(tmpl, &t->component);
+	if (ucontrol == NULL || kctl == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	ucontrol->value.integer.value[0] = val;
+	ret = kctl->put(kctl, ucontrol);
+
+out:
+	if (kctl)
+		snd_ctl_free_one(kctl);
+	kfree(ucontrol);
+	return ret;
+}
+
+static int sy24145_test_hw_params(struct sy24145_test *t, unsigned int rate,
+				  snd_pcm_format_t format)
+{
+	struct snd_pcm_hw_params *params;
+	int ret = 0;
+
+	params = kzalloc(sizeof(*params), GFP_KERNEL);
+	if (params == NULL)
+		return -ENOMEM;
+
+	hw_param_interval(params, SNDRV_PCM_HW_PARAM_RATE)->min = rate;
+	hw_param_interval(params, SNDRV_PCM_HW_PARAM_RATE)->max = rate;
+	params_set_format(params, format);
+
+	ret = sy24145_hw_params(NULL, params, &t->dai);
+	kfree(params);
+	return ret;
+}
+
+static void sy24145_test_show(struct kunit *test, struct sy24145_test *t,
+			      struct device_attribute *attr,
+			      const char *expected)
+{
+	char *buf = kunit_kzalloc(test, PAGE_SIZE, GFP_KERNEL);
+
+	KUNIT_ASSERT_NOT_NULL(test, buf);
+	KUNIT_EXPECT_GT(test, attr->show(&t->client->dev, attr, buf), 0);
+	KUNIT_EXPECT_STREQ(test, buf, expected);
+}
+
+/* A chip with its own adapter and a driver instance set up as probe does */
+static int sy24145_test_instance_init(struct kunit *test,
+				      struct sy24145_test *t)
+{
+	struct sy24145 *sy24145;
+	int ret = 0;
+
+	for (unsigned int reg = 0; reg < SY24145_NUM_REGS; ++reg)
+		if (sy24145_regs[reg].flags & SY24145_REG_HAS_DEFAULT)
+			sy24145_test_set_reg(t, reg, sy24145_regs[reg].def);
+
+	t->chip.adap.owner = THIS_MODULE;
+	t->chip.adap.algo = &sy24145_test_algo;
+	strscpy(t->chip.adap.name, "sy24145-test", sizeof(t->chip.adap.name));
+	i2c_set_adapdata(&t->chip.adap, &t->chip);
+	ret = i2c_add_adapter(&t->chip.adap);
+	if (ret < 0)
+		return ret;
+	t->chip.added = true;
+
+	t->client = i2c_new_dummy_device(&t->chip.adap, 0x2a);
+	if (IS_ERR(t->client))
+		return PTR_ERR(t->client);
+
+	sy24145 = kunit_kzalloc(test, sizeof(*sy24145), GFP_KERNEL);
+	if (sy24145 == NULL)
+		return -ENOMEM;
+	t->sy24145 = sy24145;
+
+	ret = sy24145_setup(sy24145, t->client);
+	if (ret < 0)
+		return ret;
+
+	/* What parse_dt would read, with the right channel muted */
+	sy24145->mstr_volume = 0xCF;
+	sy24145->l_volume = 0x9F;
+	sy24145->r_volume = 0x9F;
+	sy24145->r_mute = true;
+	/* No tuning firmware, hw_params must not wait for it */
+	complete_all(&sy24145->init_done);
+
+	t->component.dev = &t->client->dev;
+	t->component.regmap = sy24145->regmap;
+	mutex_init(&t->component.io_mutex);
+	t->dai.component = &t->component;
+
+	sy24145_test_mark(t);
+	return 0;
+}
+
+static void sy24145_test_instance_exit(struct sy24145_test *t)
+{
+	if (t->sy24145) {
+		cancel_work_sync(&t->sy24145->init_work);
+		cancel_work_sync(&t->sy24145->preset_work);
+		cancel_work_sync(&t->sy24145->eq_work);
+	}
+	/* Releases the regmap, it is device managed */
+	if (!IS_ERR_OR_NULL(t->client))
+		i2c_unregister_device(t->client);
+	if (t->chip.added)
+		i2c_del_adapter(&t->chip.adap);
+}
+
+/* What probe does before the component registers */
+static void sy24145_test_configuration(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	struct sy24145 *sy24145 = t->sy24145;
+	struct sy24145_op_mark mark;
+	unsigned int changed = 0;
+	unsigned int dev_id = 0;
+
+	sy24145_op_begin(sy24145, &mark);
+	KUNIT_ASSERT_EQ(test, regmap_read(sy24145->regmap, DEVICE_ID, &dev_id),
+			0);
+	KUNIT_EXPECT_EQ(test, dev_id, 0x25);
+	KUNIT_ASSERT_EQ(test, sy24145_set_configuration_settings(sy24145), 0);
+	sy24145_op_end(sy24145, SY24145_OP_PROBE, &mark);
+
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, MASTER_VOLUME), 0xCF);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, CHANNEL1_VOLUME), 0x9F);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, SOFT_MUTE) &
+			DSP_DVOL_MUTE_RIGHT_MASK, DSP_DVOL_MUTE_RIGHT);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, PWM_CONTROL) &
+			(PWM_CONTROL_STANDBY_MASK | PWM_CONTROL_SHUTDOWN_MASK),
+			PWM_CONTROL_STANDBY_EXIT | PWM_CONTROL_SHUTDOWN_EXIT);
+
+	/* One write per register that left its power-on value, no more */
+	for (unsigned int reg = 0; reg < SY24145_NUM_REGS; ++reg)
+		if ((sy24145_regs[reg].flags & SY24145_REG_HAS_DEFAULT) &&
+		    sy24145_test_reg(t, reg) != sy24145_regs[reg].def)
+			changed++;
+	KUNIT_EXPECT_EQ(test, sy24145_test_report(test, "probe"), changed);
+	sy24145_test_check_op(test, SY24145_OP_PROBE, changed);
+}
+
+static void sy24145_test_hw_params_traffic(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	unsigned int transfers = 0;
+
+	KUNIT_ASSERT_EQ(test, sy24145_test_hw_params(t, 48000,
+						     SNDRV_PCM_FORMAT_S24_LE),
+			0);
+	transfers = sy24145_test_report(test, "hw_params");
+	sy24145_test_check_op(test, SY24145_OP_HW_PARAMS, transfers);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, CLOCK_CONTROL) &
+			(FS_RATE_CNFG_MASK | BRT_SEL_MASK),
+			FS_RATE_CNFG_441_48kHZ | BRT_SEL_48kHZ);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, I2S_CONTROL) & I2S_VBITS_MASK,
+			I2S_VBITS_24);
+	sy24145_test_show(test, t, &dev_attr_sample_rate, "48000\n");
+
+	/* Reopening with the same parameters stays off the bus */
+	KUNIT_ASSERT_EQ(test, sy24145_test_hw_params(t, 48000,
+						     SNDRV_PCM_FORMAT_S24_LE),
+			0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_report(test, "hw_params"), 0);
+
+	KUNIT_ASSERT_EQ(test, sy24145_test_hw_params(t, 44100,
+						     SNDRV_PCM_FORMAT_S16_LE),
+			0);
+	transfers = sy24145_test_report(test, "hw_params");
+	sy24145_test_check_op(test, SY24145_OP_HW_PARAMS, transfers);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, I2S_CONTROL) & I2S_VBITS_MASK,
+			I2S_VBITS_16);
+
+	KUNIT_EXPECT_EQ(test, sy24145_test_hw_params(t, 22050,
+						     SNDRV_PCM_FORMAT_S16_LE),
+			-EINVAL);
+	KUNIT_EXPECT_EQ(test, sy24145_test_report(test, "hw_params"), 0);
+}
+
+static void sy24145_test_set_fmt_traffic(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	unsigned int transfers = 0;
+
+	KUNIT_ASSERT_EQ(test, sy24145_set_dai_fmt(&t->dai,
+						  SND_SOC_DAIFMT_LEFT_J |
+							  SND_SOC_DAIFMT_IB_IF),
+			0);
+	transfers = sy24145_test_report(test, "set_fmt");
+	sy24145_test_check_op(test, SY24145_OP_SET_FMT, transfers);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, I2S_CONTROL) &
+			(I2S_FMT_MASK | I2S_SCLK_INV_MASK |
+			 I2S_LR_POLARITY_MASK),
+			I2S_FMT_LJ | I2S_SCLK_INVERT | I2S_LR_POLARITY_INVERT);
+
+	KUNIT_EXPECT_EQ(test, sy24145_set_dai_fmt(&t->dai,
+						  SND_SOC_DAIFMT_DSP_A |
+							  SND_SOC_DAIFMT_NB_NF),
+			-EINVAL);
+	KUNIT_EXPECT_EQ(test, sy24145_test_report(test, "set_fmt"), 0);
+}
+
+static void sy24145_test_mute_traffic(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	unsigned int transfers = 0;
+
+	KUNIT_ASSERT_EQ(test, sy24145_mute_stream(&t->dai, 1, 0), 0);
+	transfers = sy24145_test_report(test, "mute_stream");
+	sy24145_test_check_op(test, SY24145_OP_MUTE, transfers);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, SOFT_MUTE) & DSP_MVOL_MASK,
+			DSP_MVOL_MUTE);
+	sy24145_test_show(test, t, &dev_attr_mute, "1\n");
+
+	/* Already muted, the cache says so */
+	KUNIT_ASSERT_EQ(test, sy24145_mute_stream(&t->dai, 1, 0), 0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_report(test, "mute_stream"), 0);
+
+	KUNIT_ASSERT_EQ(test, sy24145_mute_stream(&t->dai, 0, 0), 0);
+	transfers = sy24145_test_report(test, "mute_stream");
+	sy24145_test_check_op(test, SY24145_OP_MUTE, transfers);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, SOFT_MUTE) & DSP_MVOL_MASK,
+			DSP_MVOL_UNMUTE);
+	sy24145_test_show(test, t, &dev_attr_mute, "0\n");
+}
+
+static void sy24145_test_control_traffic(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	unsigned int transfers = 0;
+
+	/* Control value 0 is register value 0x3, 0xFF is 0 dB */
+	KUNIT_ASSERT_EQ(test, sy24145_test_put(t, "Master volume", 0xFF - 0x3 - 20),
+			1);
+	transfers = sy24145_test_report(test, "control_put");
+	sy24145_test_check_op(test, SY24145_OP_CONTROL, transfers);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, MASTER_VOLUME), 0xFF - 20);
+	sy24145_test_show(test, t, &dev_attr_master_volume, "-20\n");
+
+	KUNIT_ASSERT_EQ(test, sy24145_test_put(t, "Master volume", 0xFF - 0x3 - 20),
+			0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_report(test, "control_put"), 0);
+
+	KUNIT_ASSERT_EQ(test, sy24145_test_put(t, "Channel 1 soft mute", 1), 1);
+	transfers = sy24145_test_report(test, "control_put");
+	sy24145_test_check_op(test, SY24145_OP_CONTROL, transfers);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, SOFT_MUTE) &
+			DSP_DVOL_MUTE_LEFT_MASK, DSP_DVOL_MUTE_LEFT);
+	sy24145_test_show(test, t, &dev_attr_left_mute, "1\n");
+}
+
+/* Every attribute is served from memory */
+static void sy24145_test_sysfs_traffic(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	char *buf = kunit_kzalloc(test, PAGE_SIZE, GFP_KERNEL);
+
+	KUNIT_ASSERT_NOT_NULL(test, buf);
+
+	for (int i = 0; sy24145_groups[i]; ++i) {
+		struct attribute **attrs = sy24145_groups[i]->attrs;
+
+		for (int j = 0; attrs[j]; ++j) {
+			struct device_attribute *attr =
+				container_of(attrs[j], struct device_attribute,
+					     attr);
+
+			KUNIT_EXPECT_GT(test,
+					attr->show(&t->client->dev, attr, buf),
+					0);
+			KUNIT_EXPECT_EQ(test,
+					sy24145_test_report(test,
+							    attrs[j]->name),
+					0);
+		}
+	}
+}
+
+/* Adapters taking two messages per transfer still get everything */
+static void sy24145_test_max_num_msgs(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	struct sy24145 *sy24145 = t->sy24145;
+	const u8 regs[] = { DRC1_LMT_CFG1, DRC1_LMT_CFG1 + 1, DRC1_LMT_CFG1 + 2,
+			    DRC1_ENVLP_TC_UP, DRC1_ENVLP_TC_DN, MASTER_VOLUME };
+	const u32 vals[] = { 0x123456, 0x234567, 0x345678, 0x000100, 0x000200,
+			     0x80 };
+	struct sy24145_snapshot *snap;
+	u8 status[SY24145_NUM_FAULT_SRCS];
+	unsigned int val = 0;
+	u32 pll = 0;
+	int ret = 0;
+
+	t->chip.quirks.max_num_msgs = 2;
+	t->chip.adap.quirks = &t->chip.quirks;
+
+	/* Three runs of registers, the cache update adds no traffic */
+	mutex_lock(&sy24145->lock);
+	ret = sy24145_reg_batch_write(sy24145, regs, vals, ARRAY_SIZE(regs));
+	mutex_unlock(&sy24145->lock);
+	KUNIT_ASSERT_EQ(test, ret, 0);
+	KUNIT_EXPECT_EQ(test, t->chip.msgs - t->msgs, 3);
+	KUNIT_EXPECT_EQ(test, sy24145_test_report(test, "reg_batch"), 2);
+
+	for (int i = 0; i < ARRAY_SIZE(regs); ++i) {
+		KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, regs[i]), vals[i]);
+		KUNIT_ASSERT_EQ(test, regmap_read(sy24145->regmap, regs[i], &val),
+				0);
+		KUNIT_EXPECT_EQ(test, val, vals[i]);
+	}
+	sy24145_test_mark(t);
+
+	/* A plain write of a batched value still reaches the chip */
+	sy24145_test_set_reg(t, MASTER_VOLUME, 0x00);
+	KUNIT_ASSERT_EQ(test,
+			regmap_write(sy24145->regmap, MASTER_VOLUME, 0x80), 0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, MASTER_VOLUME), 0x80);
+	KUNIT_EXPECT_EQ(test, sy24145_test_report(test, "regmap_write"), 1);
+
+	sy24145_test_set_reg(t, ERROR_STATUS, ERROR_STATUS_OCF);
+	sy24145_test_set_reg(t, ERROR_DC_STATUS, ERROR_STATUS_PPEC1);
+	KUNIT_ASSERT_EQ(test, sy24145_read_faults(sy24145, status, &pll), 0);
+	KUNIT_EXPECT_EQ(test, status[SY24145_FAULT_SRC_STATUS],
+			ERROR_STATUS_OCF);
+	KUNIT_EXPECT_EQ(test, status[SY24145_FAULT_SRC_DC],
+			ERROR_STATUS_PPEC1);
+	sy24145_test_report(test, "read_faults");
+
+	snap = sy24145_snapshot(sy24145);
+	KUNIT_ASSERT_FALSE(test, IS_ERR(snap));
+	KUNIT_EXPECT_GT(test, snap->len, 0);
+	kfree(snap);
+	sy24145_test_report(test, "snapshot");
+}
+
+/*
+ * Two amplifiers on separate buses, streams at different rates: each
+ * instance keeps its own rate and only ever talks to its own chip.
+ */
+static void sy24145_test_two_instances(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	struct sy24145_test *t2;
+	size_t size = sizeof(t->chip.regs);
+	u8 *regs;
+
+	t2 = kunit_kzalloc(test, sizeof(*t2), GFP_KERNEL);
+	regs = kunit_kzalloc(test, size, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, t2);
+	KUNIT_ASSERT_NOT_NULL(test, regs);
+	t->peer = t2;
+	KUNIT_ASSERT_EQ(test, sy24145_test_instance_init(test, t2), 0);
+	KUNIT_EXPECT_NE(test, t->client->adapter->nr, t2->client->adapter->nr);
+
+	/* Probe's chip setup on each */
+	KUNIT_ASSERT_EQ(test, sy24145_set_configuration_settings(t->sy24145),
+			0);
+	KUNIT_ASSERT_EQ(test, sy24145_set_configuration_settings(t2->sy24145),
+			0);
+	sy24145_test_mark(t);
+	sy24145_test_mark(t2);
+
+	memcpy(regs, t2->chip.regs, size);
+	KUNIT_ASSERT_EQ(test, sy24145_test_hw_params(t, 48000,
+						     SNDRV_PCM_FORMAT_S24_LE),
+			0);
+	KUNIT_EXPECT_GT(test, t->chip.transfers - t->transfers, 0);
+	KUNIT_EXPECT_EQ(test, t2->chip.transfers - t2->transfers, 0);
+	KUNIT_EXPECT_MEMEQ(test, t2->chip.regs, regs, size);
+	sy24145_test_mark(t);
+
+	memcpy(regs, t->chip.regs, size);
+	KUNIT_ASSERT_EQ(test, sy24145_test_hw_params(t2, 32000,
+						     SNDRV_PCM_FORMAT_S16_LE),
+			0);
+	KUNIT_EXPECT_GT(test, t2->chip.transfers - t2->transfers, 0);
+	KUNIT_EXPECT_EQ(test, t->chip.transfers - t->transfers, 0);
+	KUNIT_EXPECT_MEMEQ(test, t->chip.regs, regs, size);
+
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, CLOCK_CONTROL) &
+			(FS_RATE_CNFG_MASK | BRT_SEL_MASK),
+			FS_RATE_CNFG_441_48kHZ | BRT_SEL_48kHZ);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t2, CLOCK_CONTROL) &
+			FS_RATE_CNFG_MASK, FS_RATE_CNFG_32kHZ);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, I2S_CONTROL) & I2S_VBITS_MASK,
+			I2S_VBITS_24);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t2, I2S_CONTROL) &
+			I2S_VBITS_MASK, I2S_VBITS_16);
+
+	sy24145_test_show(test, t, &dev_attr_sample_rate, "48000\n");
+	sy24145_test_show(test, t2, &dev_attr_sample_rate, "32000\n");
+}
+
+/*
+ * Bands checked against the RBJ cookbook in double precision, rounded to
+ * 3.23. The fixed point design may be off by an LSB or two.
+ */
+static const struct {
+	u32 type;
+	u32 freq;
+	u32 q;
+	s32 gain;
+	unsigned int rate;
+	s32 coef[SY24145_COEF_WORDS];
+} sy24145_test_eq_bands[] = {
+	{ SY24145_EQ_LOW_PASS, 1000, 71, 0, 48000,
+	  { 32862, 65724, 32862, 15233430, -6976271 } },
+	{ SY24145_EQ_HIGH_PASS, 100, 71, 0, 44100,
+	  { 8304858, -16609716, 8304858, 16608874, -8221951 } },
+	{ SY24145_EQ_PEAK, 1000, 100, 60, 48000,
+	  { 8757313, -15899103, 7278982, 15899103, -7647687 } },
+	{ SY24145_EQ_LOW_SHELF, 200, 71, -60, 48000,
+	  { 8335095, -16411578, 8080466, 16409597, -8028935 } },
+	{ SY24145_EQ_HIGH_SHELF, 8000, 71, 30, 96000,
+	  { 11135340, -14876703, 5654310, 10252557, -3776896 } },
+	{ SY24145_EQ_NOTCH, 50, 200, 0, 32000,
+	  { 8368070, -16735333, 8368070, 16735333, -8347532 } },
+	/* Pulled down to 45% of the rate, 14.4 kHz */
+	{ SY24145_EQ_PEAK, 20000, 100, 60, 32000,
+	  { 9211794, 14382834, 5911212, -14382834, -6734399 } },
+};
+
+static void sy24145_test_eq_params(struct sy24145_eq_params *params, u32 type,
+				   u32 freq, u32 q, s32 gain)
+{
+	params->type = cpu_to_le32(type);
+	params->freq = cpu_to_le32(freq);
+	params->q = cpu_to_le32(q);
+	params->gain = cpu_to_le32(gain);
+}
+
+static void sy24145_test_eq_design(struct kunit *test)
+{
+	struct sy24145_eq_params params;
+	u32 coef[SY24145_COEF_WORDS];
+
+	for (int i = 0; i < ARRAY_SIZE(sy24145_test_eq_bands); ++i) {
+		sy24145_test_eq_params(&params, sy24145_test_eq_bands[i].type,
+				       sy24145_test_eq_bands[i].freq,
+				       sy24145_test_eq_bands[i].q,
+				       sy24145_test_eq_bands[i].gain);
+		KUNIT_ASSERT_EQ(test, sy24145_eq_check(&params), 0);
+		KUNIT_ASSERT_EQ(test,
+				sy24145_eq_design(&params,
+						  sy24145_test_eq_bands[i].rate,
+						  coef),
+				0);
+
+		for (int j = 0; j < SY24145_COEF_WORDS; ++j) {
+			s32 expected = sy24145_test_eq_bands[i].coef[j];
+
+			/* 3.23 in the low 26 bits */
+			KUNIT_EXPECT_EQ(test, coef[j] & ~GENMASK(25, 0), 0);
+			KUNIT_EXPECT_LE_MSG(test,
+					    abs(sign_extend32(coef[j], 25) -
+						expected),
+					    2, "band %d word %d", i, j);
+		}
+	}
+}
+
+static void sy24145_test_eq_identity(struct kunit *test)
+{
+	struct sy24145_eq_params params;
+	u32 coef[SY24145_COEF_WORDS];
+
+	/* Bypass is a unity gain b0, whatever the other fields hold */
+	sy24145_test_eq_params(&params, SY24145_EQ_BYPASS, 0, 0, 0);
+	KUNIT_ASSERT_EQ(test, sy24145_eq_check(&params), 0);
+	KUNIT_ASSERT_EQ(test, sy24145_eq_design(&params, 48000, coef), 0);
+	KUNIT_EXPECT_EQ(test, coef[0], BIT(SY24145_COEF_FRAC));
+	for (int j = 1; j < SY24145_COEF_WORDS; ++j)
+		KUNIT_EXPECT_EQ(test, coef[j], 0);
+
+	/* A flat peak cancels its own poles */
+	sy24145_test_eq_params(&params, SY24145_EQ_PEAK, 1000, 100, 0);
+	KUNIT_ASSERT_EQ(test, sy24145_eq_design(&params, 44100, coef), 0);
+	KUNIT_EXPECT_EQ(test, coef[0], BIT(SY24145_COEF_FRAC));
+	KUNIT_EXPECT_EQ(test, sign_extend32(coef[3], 25),
+			-sign_extend32(coef[1], 25));
+	KUNIT_EXPECT_EQ(test, sign_extend32(coef[4], 25),
+			-sign_extend32(coef[2], 25));
+}
+
+static void sy24145_test_eq_check(struct kunit *test)
+{
+	struct sy24145_eq_params params;
+
+	sy24145_test_eq_params(&params, SY24145_EQ_NUM_TYPES, 1000, 100, 0);
+	KUNIT_EXPECT_EQ(test, sy24145_eq_check(&params), -EINVAL);
+	sy24145_test_eq_params(&params, SY24145_EQ_PEAK,
+			       SY24145_EQ_FREQ_MIN - 1, 100, 0);
+	KUNIT_EXPECT_EQ(test, sy24145_eq_check(&params), -EINVAL);
+	sy24145_test_eq_params(&params, SY24145_EQ_PEAK,
+			       SY24145_EQ_FREQ_MAX + 1, 100, 0);
+	KUNIT_EXPECT_EQ(test, sy24145_eq_check(&params), -EINVAL);
+	sy24145_test_eq_params(&params, SY24145_EQ_PEAK, 1000,
+			       SY24145_EQ_Q_MIN - 1, 0);
+	KUNIT_EXPECT_EQ(test, sy24145_eq_check(&params), -EINVAL);
+	sy24145_test_eq_params(&params, SY24145_EQ_PEAK, 1000,
+			       SY24145_EQ_Q_MAX + 1, 0);
+	KUNIT_EXPECT_EQ(test, sy24145_eq_check(&params), -EINVAL);
+	sy24145_test_eq_params(&params, SY24145_EQ_PEAK, 1000, 100,
+			       -SY24145_EQ_GAIN_MAX - 1);
+	KUNIT_EXPECT_EQ(test, sy24145_eq_check(&params), -EINVAL);
+	sy24145_test_eq_params(&params, SY24145_EQ_PEAK, 1000, 100,
+			       SY24145_EQ_GAIN_MAX);
+	KUNIT_EXPECT_EQ(test, sy24145_eq_check(&params), 0);
+}
+
+/* Room for a header and a few records */
+#define SY24145_TEST_FW_MAX 512
+
+static size_t sy24145_test_fw_header(u8 *buf, u16 version, u16 count)
+{
+	struct sy24145_coef_fw_header *hdr = (void *)buf;
+
+	hdr->magic = cpu_to_le32(SY24145_COEF_FW_MAGIC);
+	hdr->version = cpu_to_le16(version);
+	hdr->count = cpu_to_le16(count);
+	return sizeof(*hdr);
+}
+
+static size_t sy24145_test_fw_record(u8 *buf, u8 reg, u8 count)
+{
+	struct sy24145_coef_fw_record *rec = (void *)buf;
+
+	rec->reg = reg;
+	rec->count = count;
+	for (unsigned int i = 0; i < count * SY24145_COEF_BYTES; ++i)
+		rec->data[i] = reg + i;
+	return sizeof(*rec) + count * SY24145_COEF_BYTES;
+}
+
+static size_t sy24145_test_fw_preset(u8 *buf, u16 num_records)
+{
+	buf[0] = num_records & 0xFF;
+	buf[1] = num_records >> 8;
+	return sizeof(__le16);
+}
+
+static int sy24145_test_fw_index(struct kunit *test, const u8 *data,
+				 size_t size,
+				 struct sy24145_coef_preset *presets,
+				 unsigned int *num_presets)
+{
+	struct sy24145_test *t = test->priv;
+	struct firmware fw = { .size = size, .data = data };
+
+	return sy24145_coef_fw_index(t->sy24145, &fw, presets, num_presets);
+}
+
+static void sy24145_test_fw_parse(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	struct sy24145_coef_preset presets[SY24145_MAX_PRESETS];
+	unsigned int num_presets = 0;
+	unsigned long banks = 0;
+	struct firmware fw;
+	size_t record = 0;
+	size_t len = 0;
+	size_t pos = 0;
+	u8 *buf;
+
+	buf = kunit_kzalloc(test, SY24145_TEST_FW_MAX, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, buf);
+
+	/* Version 1, one preset touching both checksum banks */
+	len = sy24145_test_fw_header(buf, SY24145_COEF_FW_VERSION, 2);
+	len += sy24145_test_fw_record(buf + len, BQ0, 2);
+	len += sy24145_test_fw_record(buf + len, DRC_BQN0, 1);
+	KUNIT_ASSERT_EQ(test, sy24145_test_fw_index(test, buf, len, presets,
+						    &num_presets),
+			0);
+	KUNIT_EXPECT_EQ(test, num_presets, 1);
+	KUNIT_EXPECT_EQ(test, presets[0].pos,
+			sizeof(struct sy24145_coef_fw_header));
+	KUNIT_EXPECT_EQ(test, presets[0].num_records, 2);
+
+	fw.size = len;
+	fw.data = buf;
+	pos = presets[0].pos;
+	KUNIT_ASSERT_EQ(test, sy24145_coef_fw_records(t->sy24145, &fw, &pos,
+						      2, false, &banks),
+			0);
+	KUNIT_EXPECT_EQ(test, pos, len);
+	KUNIT_EXPECT_EQ(test, banks,
+			BIT(SY24145_BANK_PBQ) | BIT(SY24145_BANK_MDRC));
+
+	/* Truncated anywhere in the last record */
+	KUNIT_EXPECT_EQ(test, sy24145_test_fw_index(test, buf, len - 1,
+						    presets, &num_presets),
+			-EINVAL);
+	KUNIT_EXPECT_EQ(test, sy24145_test_fw_index(test, buf,
+						    len - SY24145_COEF_BYTES - 1,
+						    presets, &num_presets),
+			-EINVAL);
+
+	/* Version 2, two presets of one record each */
+	len = sy24145_test_fw_header(buf, SY24145_COEF_FW_VERSION_PRESETS, 2);
+	len += sy24145_test_fw_preset(buf + len, 1);
+	len += sy24145_test_fw_record(buf + len, BQ0, 1);
+	len += sy24145_test_fw_preset(buf + len, 1);
+	record = len;
+	len += sy24145_test_fw_record(buf + len, CHANNEL12_LOUDNESS, 1);
+	KUNIT_ASSERT_EQ(test, sy24145_test_fw_index(test, buf, len, presets,
+						    &num_presets),
+			0);
+	KUNIT_EXPECT_EQ(test, num_presets, 2);
+	KUNIT_EXPECT_EQ(test, presets[1].pos, record);
+	KUNIT_EXPECT_EQ(test, presets[1].num_records, 1);
+
+	/* Records outside the coefficient RAM */
+	sy24145_test_fw_record(buf + record, BQ0 - 1, 1);
+	KUNIT_EXPECT_EQ(test, sy24145_test_fw_index(test, buf, len, presets,
+						    &num_presets),
+			-EINVAL);
+	sy24145_test_fw_record(buf + record, CHANNEL12_LOUDNESS, 1);
+	buf[record + 1] = 2;
+	KUNIT_EXPECT_EQ(test, sy24145_test_fw_index(test, buf, len, presets,
+						    &num_presets),
+			-EINVAL);
+	buf[record + 1] = 0;
+	KUNIT_EXPECT_EQ(test, sy24145_test_fw_index(test, buf, len, presets,
+						    &num_presets),
+			-EINVAL);
+}
+
+static void sy24145_test_fw_header_check(struct kunit *test)
+{
+	struct sy24145_coef_preset presets[SY24145_MAX_PRESETS];
+	unsigned int num_presets = 0;
+	size_t len = 0;
+	u8 *buf;
+
+	buf = kunit_kzalloc(test, SY24145_TEST_FW_MAX, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, buf);
+
+	len = sy24145_test_fw_header(buf, SY24145_COEF_FW_VERSION, 0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_fw_index(test, buf, len - 1,
+						    presets, &num_presets),
+			-EINVAL);
+
+	buf[0] ^= 0xFF;
+	KUNIT_EXPECT_EQ(test, sy24145_test_fw_index(test, buf, len, presets,
+						    &num_presets),
+			-EINVAL);
+
+	sy24145_test_fw_header(buf, SY24145_COEF_FW_VERSION_PRESETS + 1, 0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_fw_index(test, buf, len, presets,
+						    &num_presets),
+			-EINVAL);
+
+	sy24145_test_fw_header(buf, SY24145_COEF_FW_VERSION_PRESETS, 0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_fw_index(test, buf, len, presets,
+						    &num_presets),
+			-EINVAL);
+
+	sy24145_test_fw_header(buf, SY24145_COEF_FW_VERSION_PRESETS,
+			       SY24145_MAX_PRESETS + 1);
+	KUNIT_EXPECT_EQ(test, sy24145_test_fw_index(test, buf, len, presets,
+						    &num_presets),
+			-EINVAL);
+}
+
+static void sy24145_test_be_pack(struct kunit *test)
+{
+	static const u8 expected[] = { 0x89, 0xAB, 0xCD, 0xEF };
+	u8 buf[4];
+
+	for (unsigned int width = 1; width <= 4; ++width) {
+		u32 val = 0x89ABCDEF >> (32 - 8 * width);
+
+		sy24145_val_to_be(val, buf, width);
+		KUNIT_EXPECT_MEMEQ(test, buf, expected, width);
+		KUNIT_EXPECT_EQ(test, sy24145_be_to_val(buf, width), val);
+	}
+}
+
+/* Stage coefficient registers, then flush them and read the chip */
+static void sy24145_test_coef_pack(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	struct sy24145 *sy24145 = t->sy24145;
+	const unsigned int count = 5;
+	u8 *data;
+	int ret = 0;
+
+	data = kunit_kzalloc(test, count * SY24145_COEF_BYTES, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, data);
+	for (unsigned int i = 0; i < count * SY24145_COEF_BYTES; ++i)
+		data[i] = i * 7 + 1;
+
+	/* Two registers per burst */
+	t->chip.quirks.max_write_len = 1 + 2 * SY24145_COEF_BYTES;
+	t->chip.adap.quirks = &t->chip.quirks;
+	KUNIT_EXPECT_EQ(test, sy24145_coef_burst_len(sy24145), 2);
+
+	/* Open RAM access up front, so the flush only sends the bursts */
+	KUNIT_ASSERT_EQ(test,
+			regmap_update_bits(sy24145->regmap, SYSTEM_CONTROL_1,
+					   I2C_ACCESS_COEF_RAM_EN_MASK |
+						   RAM_CH1_EN_MASK |
+						   RAM_CH2_EN_MASK,
+					   IACRE_I2C_ACCESS | RCE1_I2C_WR_ON |
+						   RCE2_I2C_WR_ON),
+			0);
+	sy24145_test_mark(t);
+
+	mutex_lock(&sy24145->coef_lock);
+	ret = sy24145_coef_stage(sy24145, BQ0 + 1, count, data);
+	mutex_unlock(&sy24145->coef_lock);
+	KUNIT_ASSERT_EQ(test, ret, 0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_report(test, "coef_stage"), 0);
+
+	/* The mirror holds the words, MSB first on the bus */
+	for (unsigned int i = 0; i < count; ++i)
+		for (int j = 0; j < SY24145_COEF_WORDS; ++j)
+			KUNIT_EXPECT_EQ(test, sy24145->coef[1 + i][j],
+					sy24145_be_to_val(data +
+							  i * SY24145_COEF_BYTES +
+							  j * 4, 4));
+	KUNIT_EXPECT_EQ(test, bitmap_weight(sy24145->coef_dirty,
+					    SY24145_NUM_COEF_REGS),
+			count);
+	KUNIT_EXPECT_TRUE(test, test_bit(1, sy24145->coef_dirty));
+
+	KUNIT_ASSERT_EQ(test, sy24145_coef_flush(sy24145), 0);
+	/* Bursts of 2, 2 and 1 registers */
+	KUNIT_EXPECT_EQ(test, t->chip.msgs - t->msgs, 3);
+	sy24145_test_report(test, "coef_flush");
+	for (unsigned int i = 0; i < count; ++i)
+		KUNIT_EXPECT_MEMEQ(test, t->chip.regs[BQ0 + 1 + i],
+				   data + i * SY24145_COEF_BYTES,
+				   SY24145_COEF_BYTES);
+	KUNIT_EXPECT_TRUE(test, bitmap_empty(sy24145->coef_dirty,
+					     SY24145_NUM_COEF_REGS));
+
+	/* Staging the same content again leaves nothing to write */
+	mutex_lock(&sy24145->coef_lock);
+	ret = sy24145_coef_stage(sy24145, BQ0 + 1, count, data);
+	mutex_unlock(&sy24145->coef_lock);
+	KUNIT_ASSERT_EQ(test, ret, 0);
+	KUNIT_EXPECT_TRUE(test, bitmap_empty(sy24145->coef_dirty,
+					     SY24145_NUM_COEF_REGS));
+	KUNIT_ASSERT_EQ(test, sy24145_coef_flush(sy24145), 0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_report(test, "coef_flush"), 0);
+}
+
+static int sy24145_test_init(struct kunit *test)
+{
+	struct sy24145_test *t;
+
+	t = kunit_kzalloc(test, sizeof(*t), GFP_KERNEL);
+	if (t == NULL)
+		return -ENOMEM;
+	test->priv = t;
+
+	return sy24145_test_instance_init(test, t);
+}
+
+static void sy24145_test_exit(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+
+	if (t == NULL)
+		return;
+
+	if (t->peer)
+		sy24145_test_instance_exit(t->peer);
+	sy24145_test_instance_exit(t);
+}
+
+/* Registers the chip does not take never reach it through the regmap */
+static void sy24145_test_access(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	struct sy24145 *sy24145 = t->sy24145;
+	unsigned int val = 0;
+	u8 buf[1] = { 0 };
+
+	KUNIT_EXPECT_LT(test, sy24145_i2c_write(t->client, DEVICE_ID, 1, buf),
+			0);
+	KUNIT_EXPECT_LT(test, sy24145_i2c_read(t->client, 0x0C, 1, buf), 0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, DEVICE_ID), 0x25);
+	sy24145_test_mark(t);
+
+	KUNIT_EXPECT_LT(test, regmap_write(sy24145->regmap, DEVICE_ID, 0), 0);
+	KUNIT_EXPECT_LT(test, regmap_read(sy24145->regmap, 0x0C, &val), 0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_report(test, "regmap_access"), 0);
+}
+
+/* Stage and flush a whole bank, the mirror then covers what verify needs */
+static void sy24145_test_load_bank(struct kunit *test, unsigned int bank)
+{
+	struct sy24145_test *t = test->priv;
+	struct sy24145 *sy24145 = t->sy24145;
+	const struct sy24145_coef_bank *b = &sy24145_coef_banks[bank];
+	unsigned int count = b->last - b->first + 1;
+	u8 *data;
+	int ret = 0;
+
+	data = kunit_kzalloc(test, count * SY24145_COEF_BYTES, GFP_KERNEL);
+	KUNIT_ASSERT_NOT_NULL(test, data);
+	for (unsigned int i = 0; i < count * SY24145_COEF_BYTES; ++i)
+		data[i] = b->first + i * 3;
+
+	mutex_lock(&sy24145->coef_lock);
+	ret = sy24145_coef_stage(sy24145, b->first, count, data);
+	mutex_unlock(&sy24145->coef_lock);
+	KUNIT_ASSERT_EQ(test, ret, 0);
+	KUNIT_ASSERT_EQ(test, sy24145_coef_flush(sy24145), 0);
+}
+
+/* The chip holds what the mirror says */
+static bool sy24145_test_bank_matches(struct sy24145_test *t,
+				      unsigned int bank)
+{
+	const struct sy24145_coef_bank *b = &sy24145_coef_banks[bank];
+
+	for (unsigned int reg = b->first; reg <= b->last; ++reg)
+		for (int i = 0; i < SY24145_COEF_WORDS; ++i)
+			if (sy24145_be_to_val(t->chip.regs[reg] + i * 4, 4) !=
+			    t->sy24145->coef[reg - BQ0][i])
+				return false;
+	return true;
+}
+
+static void sy24145_test_verify_ok(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	struct sy24145 *sy24145 = t->sy24145;
+
+	sy24145_test_load_bank(test, SY24145_BANK_PBQ);
+	sy24145_test_load_bank(test, SY24145_BANK_MDRC);
+	sy24145_test_mark(t);
+
+	/* Both banks cost one ERROR_STATUS read */
+	KUNIT_EXPECT_EQ(test,
+			sy24145_coef_verify(sy24145, BIT(SY24145_BANK_PBQ) |
+							     BIT(SY24145_BANK_MDRC)),
+			0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_report(test, "coef_verify"), 1);
+	KUNIT_EXPECT_EQ(test, t->chip.bytes - t->bytes, 0);
+	KUNIT_EXPECT_EQ(test,
+			sy24145->coef_load.checksum_retries[SY24145_BANK_PBQ],
+			0);
+	KUNIT_EXPECT_TRUE(test, sy24145_test_bank_matches(t, SY24145_BANK_PBQ));
+	KUNIT_EXPECT_TRUE(test,
+			  sy24145_test_bank_matches(t, SY24145_BANK_MDRC));
+}
+
+static void sy24145_test_verify_mismatch(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	struct sy24145 *sy24145 = t->sy24145;
+	struct sy24145_coef_load_stats *stats = &sy24145->coef_load;
+
+	/* The upload goes wrong once, the chip flags it */
+	t->chip.corrupt[SY24145_BANK_PBQ] = 1;
+	sy24145_test_load_bank(test, SY24145_BANK_PBQ);
+	KUNIT_EXPECT_FALSE(test,
+			   sy24145_test_bank_matches(t, SY24145_BANK_PBQ));
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, ERROR_STATUS),
+			ERROR_STATUS_PCE);
+
+	KUNIT_EXPECT_EQ(test, sy24145_coef_verify(sy24145,
+						  BIT(SY24145_BANK_PBQ)),
+			0);
+	KUNIT_EXPECT_EQ(test, stats->checksum_retries[SY24145_BANK_PBQ], 1);
+	KUNIT_EXPECT_EQ(test, stats->checksum_readbacks[SY24145_BANK_PBQ], 0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, ERROR_STATUS), 0);
+	KUNIT_EXPECT_TRUE(test, sy24145_test_bank_matches(t, SY24145_BANK_PBQ));
+	sy24145_test_report(test, "coef_verify");
+
+	/* A flag the read back disproves costs no rewrite */
+	sy24145->coef_readback = true;
+	sy24145_test_set_reg(t, ERROR_STATUS, ERROR_STATUS_PCE);
+	KUNIT_EXPECT_EQ(test, sy24145_coef_verify(sy24145,
+						  BIT(SY24145_BANK_PBQ)),
+			0);
+	KUNIT_EXPECT_EQ(test, stats->checksum_readbacks[SY24145_BANK_PBQ], 1);
+	KUNIT_EXPECT_EQ(test, stats->checksum_retries[SY24145_BANK_PBQ], 1);
+	/* The status read, then the address and the burst read of the bank */
+	KUNIT_EXPECT_EQ(test, t->chip.msgs - t->msgs, 4);
+	sy24145_test_report(test, "coef_verify_readback");
+}
+
+static void sy24145_test_verify_retry(struct kunit *test)
+{
+	struct sy24145_test *t = test->priv;
+	struct sy24145 *sy24145 = t->sy24145;
+
+	/* The upload and every rewrite go wrong */
+	t->chip.corrupt[SY24145_BANK_MDRC] = 1 + SY24145_COEF_RETRIES;
+	sy24145_test_load_bank(test, SY24145_BANK_MDRC);
+
+	KUNIT_EXPECT_EQ(test, sy24145_coef_verify(sy24145,
+						  BIT(SY24145_BANK_MDRC)),
+			-EIO);
+	KUNIT_EXPECT_EQ(test,
+			sy24145->coef_load.checksum_retries[SY24145_BANK_MDRC],
+			SY24145_COEF_RETRIES);
+	KUNIT_EXPECT_EQ(test,
+			sy24145->coef_load.checksum_retries[SY24145_BANK_PBQ],
+			0);
+	KUNIT_EXPECT_EQ(test, sy24145_test_reg(t, ERROR_STATUS),
+			ERROR_STATUS_DRC_CE);
+	sy24145_test_report(test, "coef_verify");
+}
+
+static struct kunit_case sy24145_test_cases[] = {
+	KUNIT_CASE(sy24145_test_configuration),
+	KUNIT_CASE(sy24145_test_hw_params_traffic),
+	KUNIT_CASE(sy24145_test_set_fmt_traffic),
+	KUNIT_CASE(sy24145_test_mute_traffic),
+	KUNIT_CASE(sy24145_test_control_traffic),
+	KUNIT_CASE(sy24145_test_sysfs_traffic),
+	KUNIT_CASE(sy24145_test_max_num_msgs),
+	KUNIT_CASE(sy24145_test_two_instances),
+	KUNIT_CASE(sy24145_test_eq_design),
+	KUNIT_CASE(sy24145_test_eq_identity),
+	KUNIT_CASE(sy24145_test_eq_check),
+	KUNIT_CASE(sy24145_test_fw_parse),
+	KUNIT_CASE(sy24145_test_fw_header_check),
+	KUNIT_CASE(sy24145_test_be_pack),
+	KUNIT_CASE(sy24145_test_coef_pack),
+	KUNIT_CASE(sy24145_test_access),
+	KUNIT_CASE(sy24145_test_verify_ok),
+	KUNIT_CASE(sy24145_test_verify_mismatch),
+	KUNIT_CASE(sy24145_test_verify_retry),
+	{}
+};
+
+static struct kunit_suite sy24145_test_suite = {
+	.name = "sy24145",
+	.init = sy24145_test_init,
+	.exit = sy24145_test_exit,
+	.test_cases = sy24145_test_cases,
+};
+
+kunit_test_suite(sy24145_test_suite);
@@ -0,0 +1,45 @@
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM sy24145
+
+#if !defined(_SY24145_TRACE_H) || defined(TRACE_HEADER_MULTI_READ)
+#define _SY24145_TRACE_H
+
+#include <linux/tracepoint.h>
+
+/* One i2c_transfer, reg is the first byte sent and len the payload size */
+TRACE_EVENT(sy24145_i2c_xfer,
+	TP_PROTO(struct device *dev, u8 reg, bool read, unsigned int len,
+		 s64 duration_ns, int ret),
+	TP_ARGS(dev, reg, read, len, duration_ns, ret),
+
+	TP_STRUCT__entry(
+		__string(name, dev_name(dev))
+		__field(u8, reg)
+		__field(bool, read)
+		__field(unsigned int, len)
+		__field(s64, duration_ns)
+		__field(int, ret)
+	),
+
+	TP_fast_assign(
+		__assign_str(name);
+		__entry->reg = reg;
+		__entry->read = read;
+		__entry->len = len;
+		__entry->duration_ns = duration_ns;
+		__entry->ret = ret;
+	),
+
+	TP_printk("%s reg=0x%02x %s len=%u duration=%lldns ret=%d",
+		  __get_str(name), __entry->reg,
+		  __entry->read ? "read" : "write", __entry->len,
+		  __entry->duration_ns, __entry->ret)
+);
+
+#endif /* _SY24145_TRACE_H */
+
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE sy24145_trace
+#include <trace/define_trace.h>